@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include "hydra_ros/input/pointcloud_adaptor.h"
+
+DEFINE_int32(width, 2048, "number of columns in the synthetic cloud");
+DEFINE_int32(height, 128, "number of rows in the synthetic cloud");
+DEFINE_int32(iterations, 50, "number of times to decode each cloud");
+
+namespace hydra {
+
+using sensor_msgs::PointField;
+
+using DecodeFunc = bool (*)(const sensor_msgs::PointCloud2&, CloudInputPacket&, bool);
+
+void addField(sensor_msgs::PointCloud2& msg,
+              const std::string& name,
+              uint32_t offset,
+              uint8_t datatype) {
+  PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  msg.fields.push_back(field);
+}
+
+sensor_msgs::PointCloud2 makeCloud(uint32_t point_step) {
+  sensor_msgs::PointCloud2 msg;
+  msg.height = FLAGS_height;
+  msg.width = FLAGS_width;
+  msg.point_step = point_step;
+  msg.row_step = msg.width * msg.point_step;
+  msg.data.resize(msg.row_step * msg.height);
+
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int> dist(0, 255);
+  for (auto& byte : msg.data) {
+    byte = dist(gen);
+  }
+
+  addField(msg, "x", 0, PointField::FLOAT32);
+  addField(msg, "y", 4, PointField::FLOAT32);
+  addField(msg, "z", 8, PointField::FLOAT32);
+  return msg;
+}
+
+double pointsPerSecond(const sensor_msgs::PointCloud2& msg, DecodeFunc decode) {
+  CloudInputPacket packet(0, 0);
+  // warm up allocations and caches
+  decode(msg, packet, false);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_iterations; ++i) {
+    decode(msg, packet, false);
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double> elapsed_s = end - start;
+  const double num_points = static_cast<double>(msg.width) * msg.height;
+  return num_points * FLAGS_iterations / elapsed_s.count();
+}
+
+void runBenchmark(const std::string& name, const sensor_msgs::PointCloud2& msg) {
+  const auto layout = detectPointcloudLayout(msg).layout;
+  const auto generic = pointsPerSecond(msg, &fillPointcloudPacketGeneric);
+  const auto specialized = pointsPerSecond(msg, &fillPointcloudPacket);
+  LOG(INFO) << name << " (" << layout << "): generic " << generic / 1.0e6
+            << " Mpts/s, specialized " << specialized / 1.0e6 << " Mpts/s ("
+            << specialized / generic << "x)";
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  using sensor_msgs::PointField;
+  LOG(INFO) << "Decoding " << FLAGS_height << " x " << FLAGS_width << " clouds "
+            << FLAGS_iterations << " times";
+
+  const auto xyz = hydra::makeCloud(12);
+  hydra::runBenchmark("xyz", xyz);
+
+  auto xyz_rgb = hydra::makeCloud(32);
+  hydra::addField(xyz_rgb, "rgb", 16, PointField::FLOAT32);
+  hydra::runBenchmark("xyz_rgb", xyz_rgb);
+
+  auto xyz_ring = hydra::makeCloud(48);
+  hydra::addField(xyz_ring, "intensity", 16, PointField::FLOAT32);
+  hydra::addField(xyz_ring, "ring", 26, PointField::UINT16);
+  hydra::runBenchmark("xyz_intensity_ring", xyz_ring);
+
+  auto xyz_label = hydra::makeCloud(16);
+  hydra::addField(xyz_label, "label", 12, PointField::UINT32);
+  hydra::runBenchmark("xyz_label", xyz_label);
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <malloc.h>
+#include <rosbag/bag.h>
+#include <tf2_msgs/TFMessage.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "hydra_ros/utils/pose_cache.h"
+
+DEFINE_string(bag_path, "", "bag to load poses from (synthetic bag if empty)");
+DEFINE_string(to_frame, "odom", "frame to look up poses in");
+DEFINE_string(from_frame, "camera", "frame to look up poses of");
+DEFINE_double(duration_s, 3600.0, "duration of the synthetic bag");
+DEFINE_double(rate_hz, 100.0, "rate of the odometry in the synthetic bag");
+DEFINE_int32(lookups, 1000000, "number of random lookups per backend");
+DEFINE_bool(use_index, false, "load the timeline backend from the pose index");
+
+namespace hydra {
+
+geometry_msgs::TransformStamped makeTransform(const std::string& parent,
+                                              const std::string& child,
+                                              const ros::Time& stamp) {
+  geometry_msgs::TransformStamped msg;
+  msg.header.stamp = stamp;
+  msg.header.frame_id = parent;
+  msg.child_frame_id = child;
+  msg.transform.rotation.w = 1.0;
+  return msg;
+}
+
+void writeSyntheticBag(const std::string& path) {
+  rosbag::Bag bag;
+  bag.open(path, rosbag::bagmode::Write);
+
+  const ros::Time start(1000.0);
+  tf2_msgs::TFMessage static_msg;
+  static_msg.transforms.push_back(makeTransform("base_link", FLAGS_from_frame, start));
+  static_msg.transforms.back().transform.translation.z = 0.5;
+  bag.write("/tf_static", start, static_msg);
+
+  const auto num_poses = static_cast<size_t>(FLAGS_duration_s * FLAGS_rate_hz);
+  for (size_t i = 0; i < num_poses; ++i) {
+    const double t = i / FLAGS_rate_hz;
+    const auto stamp = start + ros::Duration(t);
+    tf2_msgs::TFMessage msg;
+    msg.transforms.push_back(makeTransform(FLAGS_to_frame, "base_link", stamp));
+    auto& transform = msg.transforms.back().transform;
+    transform.translation.x = std::cos(0.01 * t) * 10.0;
+    transform.translation.y = std::sin(0.01 * t) * 10.0;
+    transform.rotation.z = std::sin(0.005 * t);
+    transform.rotation.w = std::cos(0.005 * t);
+    bag.write("/tf", stamp, msg);
+  }
+
+  bag.close();
+}
+
+size_t residentBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+
+  return 0;
+}
+
+size_t heapBytes() {
+  const auto info = mallinfo();
+  return static_cast<size_t>(info.uordblks) + static_cast<size_t>(info.hblkhd);
+}
+
+void runBenchmark(const std::string& name,
+                  const rosbag::Bag& bag,
+                  PoseCache::Backend backend,
+                  const std::vector<uint64_t>& stamps) {
+  const auto rss_before = residentBytes();
+  const auto heap_before = heapBytes();
+  const auto load_start = std::chrono::steady_clock::now();
+  PoseCache cache(bag, false, backend, FLAGS_use_index);
+  const std::chrono::duration<double> load_s =
+      std::chrono::steady_clock::now() - load_start;
+  const auto rss = residentBytes() - rss_before;
+  const auto heap = heapBytes() - heap_before;
+
+  // resolves the frame chain before timing
+  cache.lookupPose(stamps.front(), FLAGS_to_frame, FLAGS_from_frame);
+
+  size_t num_valid = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto stamp : stamps) {
+    num_valid += cache.lookupPose(stamp, FLAGS_to_frame, FLAGS_from_frame) ? 1 : 0;
+  }
+  const std::chrono::duration<double> elapsed_s =
+      std::chrono::steady_clock::now() - start;
+
+  LOG(INFO) << name << ": loaded in " << load_s.count() << " [s], "
+            << stamps.size() / elapsed_s.count() / 1.0e6 << " M lookups/s ("
+            << num_valid << " / " << stamps.size() << " valid), heap "
+            << heap / 1.0e6 << " MB, resident " << rss / 1.0e6 << " MB";
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::string bag_path = FLAGS_bag_path;
+  if (bag_path.empty()) {
+    bag_path = (std::filesystem::temp_directory_path() / "pose_cache_benchmark.bag");
+    LOG(INFO) << "Writing " << FLAGS_duration_s << " [s] synthetic bag to "
+              << bag_path;
+    hydra::writeSyntheticBag(bag_path);
+  }
+
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+
+  // query times are drawn from the range covered by the odometry
+  rosbag::View view(bag, rosbag::TopicQuery(std::vector<std::string>{"/tf"}));
+  const auto begin_ns = view.getBeginTime().toNSec();
+  const auto end_ns = view.getEndTime().toNSec();
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<uint64_t> dist(begin_ns, end_ns);
+  std::vector<uint64_t> stamps(FLAGS_lookups);
+  for (auto& stamp : stamps) {
+    stamp = dist(gen);
+  }
+
+  // the timeline runs first so that memory freed by tf2 is not reused
+  hydra::runBenchmark("timeline", bag, hydra::PoseCache::Backend::TIMELINE, stamps);
+  hydra::runBenchmark("tf2", bag, hydra::PoseCache::Backend::TF2, stamps);
+
+  bag.close();
+  if (FLAGS_bag_path.empty()) {
+    std::filesystem::remove(bag_path);
+    std::filesystem::remove(hydra::PoseCache::indexPath(bag_path, false));
+  }
+
+  return 0;
+}
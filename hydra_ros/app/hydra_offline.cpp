@@ -0,0 +1,80 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <config_utilities/config_utilities.h>
+#include <config_utilities/formatting/asl.h>
+#include <config_utilities/logging/log_to_glog.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <hydra/common/global_info.h>
+#include <ros/time.h>
+#include <yaml-cpp/yaml.h>
+
+#include <filesystem>
+
+#include "hydra_ros/hydra_bag_pipeline.h"
+
+DEFINE_string(config, "", "pipeline config (YAML file)");
+DEFINE_int32(robot_id, 0, "robot id");
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  config::Settings().setLogger("glog");
+  config::Settings().print_width = 100;
+  config::Settings().print_indent = 45;
+
+  // bag timestamps are used throughout, so no ros master is required
+  ros::Time::init();
+
+  const std::filesystem::path config_path(FLAGS_config);
+  CHECK(std::filesystem::exists(config_path)) << "invalid path: " << config_path;
+  const auto node = hydra::loadBagPipelineConfig(config_path);
+
+  hydra::HydraBagPipeline hydra(node, FLAGS_robot_id);
+  hydra.init();
+
+  hydra.start();
+  hydra.run();
+  hydra.stop();
+  hydra.save();
+  hydra::GlobalInfo::exit();
+
+  return 0;
+}
@@ -41,14 +41,30 @@
 #include <hydra/reconstruction/mesh_integrator.h>
 #include <hydra/reconstruction/projective_integrator.h>
 #include <hydra/utils/timing_utilities.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <future>
 
 #include "hydra_ros/utils/bag_reader.h"
+#include "hydra_ros/utils/ply_mesh_writer.h"
+#include "hydra_ros/utils/tsdf_fusion.h"
+#include "hydra_ros/utils/worker_pool.h"
 
 DEFINE_string(config, "", "config contents (in YAML)");
 DEFINE_string(output_path, "", "output directory");
 DEFINE_bool(show_timers, false, "print timers during reconstruction");
+// Segments are fused by weighted averaging, which matches serial integration up to
+// float rounding (|distance| < 1e-5 * truncation distance, colors within 1 unit)
+// except for voxels that saturate the integrator's max_weight and frames within one
+// synchronizer window of a segment boundary, which may be dropped.
+DEFINE_int32(jobs, 1, "number of segments to integrate in parallel");
+DEFINE_double(segment_duration,
+              -1.0,
+              "length of each segment [s] (bags are split evenly across jobs if < 0)");
 
 namespace hydra {
 
@@ -56,17 +72,36 @@ struct Reconstructor {
   struct Config {
     VolumetricMap::Config map;
     ProjectiveIntegratorConfig integrator;
+    MeshIntegratorConfig mesh;
+    //! Mesh updated blocks after every n frames (0 meshes everything at the end)
+    size_t mesh_every_n_frames = 20;
+    //! Vertices closer than this [m] are merged when saving the mesh
+    double weld_resolution = 1.0e-4;
   } const config;
 
   explicit Reconstructor(const Config& config)
       : config(config::checkValid(config)),
         map(config.map),
-        integrator(std::make_unique<ProjectiveIntegrator>(config.integrator)) {}
+        integrator(std::make_unique<ProjectiveIntegrator>(config.integrator)),
+        mesh_integrator(std::make_unique<MeshIntegrator>(config.mesh)) {}
 
   void update(const InputData& data) const {
     VLOG(5) << "processing data @ " << data.timestamp_ns;
-    timing::ScopedTimer timer("update_tsdf", data.timestamp_ns, true, 1, false);
-    integrator->updateMap(data, map);
+    {
+      timing::ScopedTimer timer("update_tsdf", data.timestamp_ns, true, 1, false);
+      integrator->updateMap(data, map);
+    }
+
+    ++num_frames;
+    if (config.mesh_every_n_frames && num_frames % config.mesh_every_n_frames == 0) {
+      updateMesh(data.timestamp_ns);
+    }
+  }
+
+  //! Mesh every block that changed since the last call
+  void updateMesh(uint64_t timestamp_ns = 0) const {
+    timing::ScopedTimer timer("update_mesh", timestamp_ns, true, 1, false);
+    mesh_integrator->generateMesh(map, true, true);
   }
 
   void reconstruct(const std::string& output_dir) {
@@ -77,9 +112,7 @@ struct Reconstructor {
 
     {
       timing::ScopedTimer timer("reconstruct_mesh", 0, true, 1);
-      MeshIntegratorConfig mesh_config;
-      MeshIntegrator mesh_integrator(mesh_config);
-      mesh_integrator.generateMesh(map, false, false);
+      updateMesh();
     }
 
     std::filesystem::path output_path(output_dir);
@@ -87,24 +120,47 @@ struct Reconstructor {
       std::filesystem::create_directories(output_path);
     }
 
-    Mesh full_mesh;
+    LOG(INFO) << "Saving mesh and tsdf to " << output_path;
     {
-      timing::ScopedTimer timer("connect_mesh", 0, true, 1);
-      // TODO(lschmid): BROKEN fix the mesh connecting. Can be implemented by adapting
-      // this
-      // https://github.mit.edu/SPARK/Hydra/blob/66b701702adb51a4c076ba0e26baf59462863d5a/eval/tools/compress_graph.cpp#L201-L217
-      // to 'full_mesh = connectMesh(map.getMeshLayer());'
-      LOG(ERROR) << "Mesh blocks  are currently not being connected!";
+      // blocks are welded and streamed to disk one at a time
+      timing::ScopedTimer timer("save_mesh", 0, true, 1);
+      // vertices shared between blocks lie within a voxel of the block faces
+      const auto voxel_size = config.map.voxel_size;
+      PlyMeshWriter writer(output_path / "mesh.ply",
+                           config.weld_resolution,
+                           voxel_size * config.map.voxels_per_side,
+                           voxel_size);
+      for (const auto& block : map.getMeshLayer()) {
+        writer.addMesh(block);
+      }
+
+      if (!writer.finish()) {
+        LOG(ERROR) << "Failed to save mesh!";
+      }
+
+      LOG(INFO) << "Saved mesh with " << writer.numVertices() << " vertices and "
+                << writer.numFaces() << " faces (" << writer.numWelded()
+                << " vertices welded)";
     }
 
-    LOG(INFO) << "Saving mesh and tsdf to " << output_path;
-    timing::ScopedTimer io_timer("save_files", 0, true, 1);
-    full_mesh.save(output_path / "mesh");
+    timing::ScopedTimer io_timer("save_map", 0, true, 1);
     map.save(output_path / "map");
   }
 
+  //! Fuse the TSDF of another reconstruction into this one
+  void merge(const Reconstructor& other, WorkerPool* pool = nullptr) {
+    timing::ScopedTimer timer("merge_tsdf", 0, true, 1);
+    const auto num_blocks = fuseTsdfLayers(other.map.getTsdfLayer(),
+                                           map.getTsdfLayer(),
+                                           config.integrator.max_weight,
+                                           pool);
+    VLOG(1) << "Fused " << num_blocks << " blocks";
+  }
+
   mutable VolumetricMap map;
   std::unique_ptr<ProjectiveIntegrator> integrator;
+  std::unique_ptr<MeshIntegrator> mesh_integrator;
+  mutable size_t num_frames = 0;
 };
 
 void declare_config(Reconstructor::Config& config) {
@@ -112,6 +168,67 @@ void declare_config(Reconstructor::Config& config) {
   name("Reconstructor::Config");
   field(config.map, "map");
   field(config.integrator, "integrator");
+  field(config.mesh, "mesh");
+  field(config.mesh_every_n_frames, "mesh_every_n_frames");
+  field(config.weld_resolution, "weld_resolution");
+  check(config.weld_resolution, GT, 0.0, "weld_resolution");
+}
+
+double bagDuration(const BagConfig& config) {
+  rosbag::Bag bag;
+  bag.open(config.bag_path, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery({config.color_topic, config.depth_topic}));
+  if (!view.size()) {
+    return 0.0;
+  }
+
+  const auto length = (view.getEndTime() - view.getBeginTime()).toSec();
+  const auto start = std::max(config.start, 0.0);
+  const auto remaining = std::max(length - start, 0.0);
+  return config.duration >= 0.0 ? std::min(remaining, config.duration) : remaining;
+}
+
+/**
+ * @brief Split bags into contiguous time segments that can be integrated independently
+ *
+ * Every bag is its own segment unless a segment duration is given or there are more
+ * jobs than bags, in which case each bag is split evenly.
+ */
+std::vector<BagConfig> partitionBags(const std::vector<BagConfig>& bags,
+                                     size_t num_jobs,
+                                     double segment_duration) {
+  const size_t pieces_per_bag = (num_jobs + bags.size() - 1) / bags.size();
+  if (segment_duration <= 0.0 && pieces_per_bag <= 1) {
+    return bags;
+  }
+
+  std::vector<BagConfig> segments;
+  for (const auto& bag : bags) {
+    const auto duration = bagDuration(bag);
+    const auto length =
+        segment_duration > 0.0 ? segment_duration : duration / pieces_per_bag;
+    if (length <= 0.0) {
+      segments.push_back(bag);
+      continue;
+    }
+
+    const auto start = std::max(bag.start, 0.0);
+    const size_t num_segments = std::max(std::ceil(duration / length - 1.0e-6), 1.0);
+    for (size_t i = 0; i < num_segments; ++i) {
+      auto segment = bag;
+      segment.start = start + i * length;
+      // the reader includes both endpoints, so the next segment owns the boundary
+      const bool is_last = i + 1 == num_segments;
+      if (!is_last) {
+        segment.duration = length - 1.0e-9;
+      } else if (bag.duration >= 0.0) {
+        segment.duration = bag.duration - i * length;
+      }
+      segments.push_back(segment);
+    }
+  }
+
+  return segments;
 }
 
 }  // namespace hydra
@@ -150,14 +267,53 @@ int main(int argc, char* argv[]) {
   const auto config = config::fromYaml<ReconstructMeshConfig>(node);
   VLOG(1) << std::endl << config::toString(config);
 
-  hydra::BagReader reader(config.reader);
-  auto reconstructor = std::make_shared<hydra::Reconstructor>(config.reconstructor);
-  auto sink = hydra::BagReader::Sink::fromMethod(&hydra::Reconstructor::update,
-                                                 reconstructor.get());
-  reader.addSink(sink);
+  const size_t num_jobs = std::max(FLAGS_jobs, 1);
+  const auto segments =
+      num_jobs > 1 && !config.reader.bags.empty()
+          ? hydra::partitionBags(config.reader.bags, num_jobs, FLAGS_segment_duration)
+          : config.reader.bags;
+
+  // every segment is integrated into its own map by its own reader
+  const auto read_segment = [&](const std::vector<hydra::BagConfig>& bags,
+                                bool incremental_mesh) {
+    auto reader_config = config.reader;
+    reader_config.bags = bags;
+    hydra::BagReader reader(reader_config);
+    auto reconstructor_config = config.reconstructor;
+    if (!incremental_mesh) {
+      reconstructor_config.mesh_every_n_frames = 0;
+    }
+
+    auto reconstructor = std::make_shared<hydra::Reconstructor>(reconstructor_config);
+    auto sink = hydra::BagReader::Sink::fromMethod(&hydra::Reconstructor::update,
+                                                   reconstructor.get());
+    reader.addSink(sink);
+    reader.read();
+    return reconstructor;
+  };
 
   LOG(INFO) << "Parsing bags...";
-  reader.read();
+  std::shared_ptr<hydra::Reconstructor> reconstructor;
+  if (num_jobs <= 1 || segments.size() <= 1) {
+    reconstructor = read_segment(segments, true);
+  } else {
+    LOG(INFO) << "Integrating " << segments.size() << " segments with " << num_jobs
+              << " jobs";
+    hydra::WorkerPool pool(std::min(num_jobs, segments.size()));
+    std::vector<std::future<std::shared_ptr<hydra::Reconstructor>>> results;
+    for (const auto& segment : segments) {
+      results.push_back(
+          // segments are only meshed once they have been fused
+          pool.submit([&, segment]() { return read_segment({segment}, false); }));
+    }
+
+    // segments are fused in order so that the result doesn't depend on scheduling
+    reconstructor = results.front().get();
+    hydra::WorkerPool merge_pool(num_jobs - 1);
+    for (size_t i = 1; i < results.size(); ++i) {
+      reconstructor->merge(*results[i].get(), &merge_pool);
+    }
+  }
   LOG(INFO) << "Finished parsing";
   LOG(INFO) << "Reconstructing and saving mesh...";
   reconstructor->reconstruct(FLAGS_output_path);
@@ -0,0 +1,138 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/hydra_pipeline.h>
+#include <yaml-cpp/yaml.h>
+
+#include <filesystem>
+
+#include "hydra_ros/input/bag_input_module.h"
+
+namespace rosbag {
+class MessageInstance;
+}
+
+namespace hydra {
+
+struct HydraBagConfig {
+  //! Bags to read (in order)
+  std::vector<std::string> bags;
+  //! Offset from the start of each bag (negative reads from the start)
+  double start = -1.0;
+  //! Maximum duration read from each bag (negative reads everything)
+  double duration = -1.0;
+  //! Push one packet at a time through every module so that the output is repeatable
+  bool lockstep = true;
+  //! Maximum number of queued packets when not running in lockstep
+  size_t max_pending = 10;
+  //! Pose graph topic forwarded to BagPoseGraphTracker (empty disables)
+  std::string pose_graph_topic = "/pose_graph";
+  //! Agent node measurement topic forwarded to BagPoseGraphTracker (empty disables)
+  std::string prior_topic;
+  //! Time between checks of the module queues
+  double poll_period_s = 1.0e-4;
+  BagInputModule::Config input;
+};
+
+void declare_config(HydraBagConfig& config);
+
+/**
+ * @brief Load the config for the offline pipeline
+ *
+ * Files listed under 'include' are merged in first (under 'ns' if given, and at the
+ * top level otherwise), so existing module configs can be reused, e.g.,
+ *
+ *   include:
+ *     - {path: path/to/frontend_config.yaml, ns: frontend}
+ *
+ * Relative paths are resolved against the including file, and values in the including
+ * file take precedence.
+ */
+YAML::Node loadBagPipelineConfig(const std::filesystem::path& path);
+
+/**
+ * @brief Runs the full pipeline on recorded data without a ROS master
+ *
+ * Packets are read from each bag and pushed into the input module as fast as the
+ * modules consume them. Modules are configured from a single YAML node laid out like
+ * the parameters of the online pipeline (see config/offline/uhumans2.yaml).
+ *
+ * In lockstep, each packet is forwarded to reconstruction once the previous one has
+ * left every module queue. This relies on two properties of the hydra modules that
+ * are not enforced here: a module only pops its input once it has finished with it,
+ * and the frontend pushes to the backend queue before popping its own input.
+ * scripts/check_offline_determinism.sh verifies the result by running a bag twice and
+ * comparing the saved graphs.
+ */
+class HydraBagPipeline : public HydraPipeline {
+ public:
+  HydraBagPipeline(const YAML::Node& config, int robot_id);
+
+  virtual ~HydraBagPipeline();
+
+  void init() override;
+
+  //! Read every bag and return once all packets have been processed
+  void run();
+
+ protected:
+  virtual void initFrontend();
+  virtual void initBackend();
+  virtual void initReconstruction();
+  virtual void initLCD();
+
+  void readBag(const std::string& bag_path);
+  void handlePoseGraph(const rosbag::MessageInstance& msg);
+  void pushPacket(BagDataReceiver& receiver, InputPacket::Ptr&& packet);
+  size_t numPending() const;
+  bool idle() const;
+  void waitUntilIdle() const;
+  void sleep() const;
+
+ protected:
+  const YAML::Node node_;
+  const HydraBagConfig config_;
+  BagInputModule* bag_input_;
+  std::vector<BagDataReceiver*> receivers_;
+  //! Output of the input module (only separate from the reconstruction queue in
+  //! lockstep)
+  BagInputModule::OutputQueue::Ptr input_queue_;
+  BagInputModule::OutputQueue::Ptr reconstruction_queue_;
+  size_t num_packets_;
+  size_t num_rejected_;
+  size_t num_dropped_;
+};
+
+}  // namespace hydra
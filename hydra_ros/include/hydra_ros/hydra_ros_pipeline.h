@@ -49,6 +49,12 @@ struct HydraRosConfig {
 
 void declare_config(HydraRosConfig& conf);
 
+class BackendModule;
+class FrontendModule;
+
+//! Add the backend functors required by the frontend configuration
+void addBackendUpdateFunctors(BackendModule& backend, const FrontendModule& frontend);
+
 class HydraRosPipeline : public HydraPipeline {
  public:
   HydraRosPipeline(const ros::NodeHandle& nh, int robot_id);
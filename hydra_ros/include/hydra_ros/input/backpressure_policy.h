@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace hydra {
+
+/**
+ * @brief Decides whether a receiver keeps an incoming message given downstream load
+ *
+ * The policy is evaluated before any conversion work and only applies once the number
+ * of queued packets (receiver queue plus reconstruction queue) exceeds
+ * max_queue_depth.
+ */
+class BackpressurePolicy {
+ public:
+  enum class Mode {
+    NONE,            //!< keep everything
+    KEEP_LATEST,     //!< keep the new message and drop packets waiting in the receiver
+    KEEP_EVERY_NTH,  //!< keep one in every keep_every_n messages
+    DROP,            //!< drop new messages
+  };
+
+  struct Config {
+    //! One of "none", "keep_latest", "keep_every_nth" or "drop"
+    std::string mode = "none";
+    //! The policy applies once more than this many packets are queued
+    size_t max_queue_depth = 5;
+    //! Ratio of messages kept by "keep_every_nth" while over max_queue_depth
+    size_t keep_every_n = 2;
+  } const config;
+
+  struct Decision {
+    //! Whether to convert and queue the new message
+    bool keep = true;
+    //! Whether packets waiting in the receiver queue should be dropped
+    bool clear_queue = false;
+  };
+
+  explicit BackpressurePolicy(const Config& config);
+
+  /**
+   * @brief Record a new message and decide what to do with it
+   * @param receiver_depth Number of packets waiting in the receiver queue
+   * @param downstream_depth Number of packets waiting for reconstruction
+   */
+  Decision update(size_t receiver_depth, size_t downstream_depth);
+
+  Mode mode() const { return mode_; }
+
+  size_t numReceived() const { return num_received_; }
+
+  size_t numDropped() const { return num_dropped_; }
+
+ private:
+  const Mode mode_;
+  std::atomic<size_t> num_received_;
+  std::atomic<size_t> num_dropped_;
+  size_t num_since_kept_;
+};
+
+std::ostream& operator<<(std::ostream& out, BackpressurePolicy::Mode mode);
+
+void declare_config(BackpressurePolicy::Config& config);
+
+}  // namespace hydra
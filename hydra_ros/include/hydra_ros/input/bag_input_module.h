@@ -0,0 +1,160 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/input/data_receiver.h>
+#include <hydra/input/input_module.h>
+#include <hydra/input/sensor_input_packet.h>
+
+#include <memory>
+#include <mutex>
+
+#include "hydra_ros/input/image_decimator.h"
+#include "hydra_ros/utils/pose_cache.h"
+#include "hydra_ros/utils/stamp_join.h"
+
+namespace rosbag {
+class MessageInstance;
+}
+
+namespace hydra {
+
+/**
+ * @brief Receiver for packets read from a bag by the offline pipeline
+ *
+ * Color and label images are paired with depth images by their header stamps (see
+ * StampJoin). Empty topics are ignored, and a receiver with a cloud topic emits one
+ * packet per cloud.
+ */
+class BagDataReceiver : public DataReceiver {
+ public:
+  struct Config : DataReceiver::Config {
+    std::string color_topic;
+    std::string depth_topic;
+    std::string label_topic;
+    std::string cloud_topic;
+    //! Cropping and decimation applied to every image (must match the sensor config)
+    ImageDecimator::Config decimation;
+    //! Stamp tolerance and bound on unpaired images
+    StampJoinConfig stamp_join;
+  };
+
+  BagDataReceiver(const Config& config, size_t sensor_id);
+
+  virtual ~BagDataReceiver() = default;
+
+  //! All (non-empty) topics used by the receiver
+  std::vector<std::string> topics() const;
+
+  /**
+   * @brief Convert a message into a packet
+   * @returns The packet once every image for the stamp has been read or nullptr
+   */
+  InputPacket::Ptr convert(const rosbag::MessageInstance& msg);
+
+  /**
+   * @brief Queue a packet for the input module
+   * @returns False if the packet was rejected by the input timestamp checks
+   */
+  bool push(const InputPacket::Ptr& packet);
+
+  //! Drop every unpaired image (e.g., at the end of a bag)
+  void flush();
+
+  //! Number of images dropped without being paired
+  size_t numUnmatched() const;
+
+ public:
+  const Config config;
+
+ protected:
+  bool initImpl() override { return true; }
+
+ private:
+  struct Frame {
+    uint64_t timestamp_ns = 0;
+    cv::Mat color;
+    cv::Mat depth;
+    cv::Mat labels;
+  };
+
+  InputPacket::Ptr convertCloud(const rosbag::MessageInstance& msg) const;
+
+  //! Pair depth (and color) with labels if required, and emit the frame otherwise
+  void addDepthFrame(const Frame& frame);
+
+  void emit(const Frame& frame);
+
+  const ImageDecimator decimator_;
+  //! Pairs color (input 0) with depth (input 1)
+  std::unique_ptr<StampJoin<Frame>> color_join_;
+  //! Pairs depth and color (input 0) with labels (input 1)
+  std::unique_ptr<StampJoin<Frame>> label_join_;
+  InputPacket::Ptr ready_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<DataReceiver,
+                                     BagDataReceiver,
+                                     BagDataReceiver::Config,
+                                     size_t>("BagReceiver");
+};
+
+/**
+ * @brief Input module that looks up body poses in a pose cache instead of tf
+ */
+class BagInputModule : public InputModule {
+ public:
+  using OutputQueue = InputQueue<InputPacket::Ptr>;
+
+  BagInputModule(const Config& config, const OutputQueue::Ptr& output_queue);
+
+  virtual ~BagInputModule() = default;
+
+  //! Set the poses for the next bag (only while no packets are queued)
+  void setPoses(const std::shared_ptr<const PoseCache>& poses);
+
+  std::vector<BagDataReceiver*> receivers() const;
+
+ protected:
+  PoseStatus getBodyPose(uint64_t timestamp_ns) override;
+
+ private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<const PoseCache> poses_;
+};
+
+void declare_config(BagDataReceiver::Config& config);
+
+}  // namespace hydra
@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/sensor_input_packet.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Groups packets from several cameras into batches by timestamp
+ *
+ * Each camera registers a sink and gets a slot. A batch opens with the first packet
+ * and is emitted (in slot order) once every camera has contributed or once a packet
+ * arrives outside the window. Cameras that miss the window are skipped, and packets
+ * that arrive after their batch was emitted are dropped. Every emitted batch gets an id
+ * that is unique across groups so that consumers can tell which packets belong
+ * together.
+ */
+class ImageBatcher {
+ public:
+  using Ptr = std::shared_ptr<ImageBatcher>;
+  using Sink = std::function<void(const InputPacket::Ptr&)>;
+
+  explicit ImageBatcher(double window_s);
+
+  /**
+   * @brief Get the batcher shared by all cameras in the group (created if needed)
+   */
+  static Ptr getGroup(const std::string& group, double window_s);
+
+  /**
+   * @brief Get the id of the batch that a recently emitted packet belonged to
+   *
+   * Only the most recent packets are tracked, and packets are identified by their
+   * timestamp, so packets with the same stamp in different groups share an id.
+   */
+  static std::optional<uint64_t> findBatch(uint64_t timestamp_ns);
+
+  //! Register a camera and get its slot
+  size_t addCamera(const Sink& sink);
+
+  //! Stop forwarding packets for the slot (the slot is skipped in later batches)
+  void removeCamera(size_t slot);
+
+  void submit(size_t slot, const InputPacket::Ptr& packet);
+
+  //! Emit the current batch even if it is incomplete
+  void flush();
+
+  size_t numCameras() const;
+
+  size_t numBatches() const;
+
+  size_t numSkipped() const;
+
+  size_t numDropped() const;
+
+ public:
+  const uint64_t window_ns;
+
+ private:
+  using Batch = std::vector<std::pair<Sink, InputPacket::Ptr>>;
+
+  size_t numActive() const;
+
+  Batch takeBatch();
+
+  mutable std::mutex mutex_;
+  std::vector<Sink> sinks_;
+  std::vector<InputPacket::Ptr> current_;
+  size_t num_filled_;
+  uint64_t reference_ns_;
+  size_t num_batches_;
+  size_t num_skipped_;
+  size_t num_dropped_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,85 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/camera.h>
+
+#include <opencv2/core.hpp>
+
+namespace hydra {
+
+/**
+ * @brief Crops and stride-decimates images at ingestion
+ *
+ * The region of interest is applied first, then every `stride`-th pixel of the
+ * region is kept. Cropping without decimation only changes the image header.
+ */
+class ImageDecimator {
+ public:
+  struct Config {
+    //! Keep every n-th pixel in each direction
+    int stride = 1;
+    //! Use the minimum valid depth in each stride x stride window instead of nearest
+    bool min_pool_depth = false;
+    //! Column of the top-left corner of the region of interest
+    int roi_x = 0;
+    //! Row of the top-left corner of the region of interest
+    int roi_y = 0;
+    //! Width of the region of interest (non-positive uses the rest of the image)
+    int roi_width = 0;
+    //! Height of the region of interest (non-positive uses the rest of the image)
+    int roi_height = 0;
+  } const config;
+
+  explicit ImageDecimator(const Config& config);
+
+  //! Whether the decimator modifies images at all
+  bool enabled() const;
+
+  //! Get the region of interest for an image of the given size
+  cv::Rect roi(int width, int height) const;
+
+  //! Decimate a depth image (16UC1 or 32FC1) using nearest or min-pooling
+  cv::Mat depth(const cv::Mat& image) const;
+
+  //! Decimate an image of any type (e.g., color or labels) using nearest sampling
+  cv::Mat nearest(const cv::Mat& image) const;
+
+  //! Adjust camera intrinsics (and image size) to match decimated images
+  void scaleIntrinsics(Camera::Config& config) const;
+};
+
+void declare_config(ImageDecimator::Config& config);
+
+}  // namespace hydra
@@ -34,14 +34,19 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <config_utilities/factory.h>
-#include <hydra/input/data_receiver.h>
 #include <image_transport/image_transport.h>
 #include <image_transport/subscriber_filter.h>
 #include <message_filters/subscriber.h>
 #include <message_filters/sync_policies/approximate_time.h>
 #include <ros/ros.h>
+#include <sensor_msgs/CompressedImage.h>
 #include <sensor_msgs/Image.h>
 
+#include "hydra_ros/input/image_batcher.h"
+#include "hydra_ros/input/image_decimator.h"
+#include "hydra_ros/input/ros_data_receiver.h"
+#include "hydra_ros/utils/decode_stage.h"
+
 namespace hydra {
 
 struct ImageSubscriber {
@@ -56,21 +61,39 @@ struct ImageSubscriber {
   std::shared_ptr<image_transport::SubscriberFilter> sub;
 };
 
-class ImageReceiver : public DataReceiver {
+class ImageReceiver : public RosDataReceiver {
  public:
   using SyncPolicy = message_filters::sync_policies::
       ApproximateTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::Image>;
   using Synchronizer = message_filters::Synchronizer<SyncPolicy>;
+  using CompressedSyncPolicy =
+      message_filters::sync_policies::ApproximateTime<sensor_msgs::CompressedImage,
+                                                      sensor_msgs::CompressedImage,
+                                                      sensor_msgs::CompressedImage>;
+  using CompressedSynchronizer = message_filters::Synchronizer<CompressedSyncPolicy>;
 
-  struct Config : DataReceiver::Config {
+  struct Config : RosDataReceiver::Config {
     std::string ns = "~";
     size_t queue_size = 10;
+    //! Cropping and decimation applied to every image (must match the sensor config)
+    ImageDecimator::Config decimation;
+    //! Receivers with the same (non-empty) group emit their images in batches
+    std::string batch_group = "";
+    //! Max time difference between images in the same batch
+    double batch_window_s = 0.02;
+    //! Subscribe to compressed (and compressedDepth) topics and decode in parallel
+    bool compressed = false;
+    //! Thread pool used to decode compressed images
+    DecodeStage::Config decoding;
   };
 
   ImageReceiver(const Config& config, size_t sensor_id);
 
   virtual ~ImageReceiver();
 
+  //! Total number of image bytes copied while converting messages to packets
+  inline size_t bytesCopied() const { return bytes_copied_; }
+
  public:
   const Config config;
 
@@ -82,11 +105,28 @@ class ImageReceiver : public DataReceiver {
                 const sensor_msgs::Image::ConstPtr& depth,
                 const sensor_msgs::Image::ConstPtr& labels);
 
+  void compressedCallback(const sensor_msgs::CompressedImage::ConstPtr& color,
+                          const sensor_msgs::CompressedImage::ConstPtr& depth,
+                          const sensor_msgs::CompressedImage::ConstPtr& labels);
+
+  void decimate(ImageInputPacket& packet) const;
+
+  void dispatch(const InputPacket::Ptr& packet);
+
   ros::NodeHandle nh_;
   ImageSubscriber color_sub_;
   ImageSubscriber depth_sub_;
   ImageSubscriber label_sub_;
   std::unique_ptr<Synchronizer> synchronizer_;
+  message_filters::Subscriber<sensor_msgs::CompressedImage> color_compressed_sub_;
+  message_filters::Subscriber<sensor_msgs::CompressedImage> depth_compressed_sub_;
+  message_filters::Subscriber<sensor_msgs::CompressedImage> label_compressed_sub_;
+  std::unique_ptr<CompressedSynchronizer> compressed_synchronizer_;
+  std::unique_ptr<DecodeStage> decode_stage_;
+  size_t bytes_copied_;
+  ImageDecimator decimator_;
+  ImageBatcher::Ptr batcher_;
+  size_t batch_slot_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DataReceiver,
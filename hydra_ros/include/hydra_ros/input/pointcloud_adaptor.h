@@ -37,9 +37,12 @@
 #include <sensor_msgs/PointCloud2.h>
 
 #include <functional>
+#include <ostream>
 
 namespace hydra {
 
+class WorkerPool;
+
 class PointcloudAdaptor {
  public:
   PointcloudAdaptor(const sensor_msgs::PointCloud2& cloud);
@@ -62,8 +65,54 @@ class PointcloudAdaptor {
   std::function<cv::Vec3b(const uint8_t*)> color_parser_;
 };
 
+//! Point layouts that have a specialized decoding loop
+enum class PointcloudLayout {
+  GENERIC,             //! any layout not covered below (uses PointcloudAdaptor)
+  XYZ,                 //! little-endian float32 x, y, z at offsets 0, 4, 8
+  XYZ_RGB,             //! packed xyz with a packed rgb(a) field
+  XYZ_INTENSITY_RING,  //! packed xyz with a ring field (typical for lidars)
+  XYZ_LABEL,           //! packed xyz with an integer label field
+  XYZ_RGB_LABEL,       //! packed xyz with both packed rgb(a) and a label field
+};
+
+std::ostream& operator<<(std::ostream& out, PointcloudLayout layout);
+
+struct PointcloudLayoutInfo {
+  PointcloudLayout layout = PointcloudLayout::GENERIC;
+  bool has_color = false;
+  uint32_t color_offset = 0;
+  bool has_label = false;
+  uint32_t label_offset = 0;
+  uint8_t label_datatype = 0;
+};
+
+/**
+ * @brief Detect whether the cloud matches one of the specialized layouts
+ *
+ * Detection only looks at the field descriptions, so it only needs to be run once per
+ * message (or once per topic if the field layout is known to be fixed)
+ */
+PointcloudLayoutInfo detectPointcloudLayout(const sensor_msgs::PointCloud2& msg);
+
+/**
+ * @brief Decode a cloud field-by-field through PointcloudAdaptor
+ *
+ * Works for any supported field layout, but pays an indirect call per field per point
+ */
+bool fillPointcloudPacketGeneric(const sensor_msgs::PointCloud2& msg,
+                                 CloudInputPacket& packet,
+                                 bool labels_required);
+
+/**
+ * @brief Decode a cloud into the packet, using a specialized loop when possible
+ *
+ * Falls back to fillPointcloudPacketGeneric for layouts that are not recognized. If a
+ * worker pool is provided, rows are split across the pool; every row is written by
+ * exactly one thread, so the output is identical to the serial output.
+ */
 bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
                           CloudInputPacket& packet,
-                          bool labels_required);
+                          bool labels_required,
+                          WorkerPool* pool = nullptr);
 
 }  // namespace hydra
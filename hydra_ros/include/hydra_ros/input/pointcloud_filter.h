@@ -0,0 +1,80 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/sensor_input_packet.h>
+
+#include <limits>
+
+namespace hydra {
+
+/**
+ * @brief Range, height and voxel-grid filter applied to decoded clouds
+ *
+ * Range and height are measured in the frame of the cloud and are only applied to
+ * clouds in the sensor frame (i.e., not to clouds already in the world frame).
+ * Non-finite points are always dropped. Filtered clouds are unorganized (i.e., a
+ * single row of points).
+ */
+class PointcloudFilter {
+ public:
+  struct Config {
+    //! Points closer than this are dropped
+    float min_range = 0.0f;
+    //! Points farther than this are dropped (disabled if non-positive)
+    float max_range = 0.0f;
+    //! Points with a z coordinate below this are dropped
+    float min_z = -std::numeric_limits<float>::infinity();
+    //! Points with a z coordinate above this are dropped
+    float max_z = std::numeric_limits<float>::infinity();
+    //! Only the first point in each voxel of this size is kept (disabled if
+    //! non-positive)
+    float voxel_size = 0.0f;
+  } const config;
+
+  explicit PointcloudFilter(const Config& config);
+
+  //! Whether any of the filters are enabled
+  bool enabled() const;
+
+  /**
+   * @brief Filter the packet in place in a single pass
+   * @returns Number of points kept
+   */
+  size_t filter(CloudInputPacket& packet) const;
+};
+
+void declare_config(PointcloudFilter::Config& config);
+
+}  // namespace hydra
@@ -34,17 +34,25 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <config_utilities/factory.h>
-#include <hydra/input/data_receiver.h>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
 
+#include "hydra_ros/input/pointcloud_filter.h"
+#include "hydra_ros/input/ros_data_receiver.h"
+
 namespace hydra {
 
-class PointcloudReceiver : public DataReceiver {
+class WorkerPool;
+
+class PointcloudReceiver : public RosDataReceiver {
  public:
-  struct Config : DataReceiver::Config {
+  struct Config : RosDataReceiver::Config {
     std::string ns = "~";
     size_t queue_size = 10;
+    //! Number of threads used to decode each cloud (1 decodes on the callback thread)
+    size_t num_decode_threads = 1;
+    //! Optional range, height and voxel filter applied to each decoded cloud
+    PointcloudFilter::Config filter;
   };
 
   PointcloudReceiver(const Config& config, size_t sensor_id);
@@ -58,10 +66,12 @@ class PointcloudReceiver : public DataReceiver {
   bool initImpl() override;
 
  private:
-  void callback(const sensor_msgs::PointCloud2& cloud);
+  void callback(const sensor_msgs::PointCloud2::ConstPtr& cloud);
 
   ros::NodeHandle nh_;
   ros::Subscriber cloud_sub_;
+  std::unique_ptr<WorkerPool> decode_pool_;
+  PointcloudFilter filter_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DataReceiver,
@@ -70,4 +80,6 @@ class PointcloudReceiver : public DataReceiver {
                                      size_t>("PointcloudReceiver");
 };
 
+void declare_config(PointcloudReceiver::Config& config);
+
 }  // namespace hydra
@@ -0,0 +1,99 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/data_receiver.h>
+
+#include <functional>
+
+#include "hydra_ros/input/backpressure_policy.h"
+#include "hydra_ros/input/tf_packet_gate.h"
+
+namespace hydra {
+
+/**
+ * @brief Shared base for receivers fed by ROS subscriptions
+ */
+class RosDataReceiver : public DataReceiver {
+ public:
+  using DepthFunction = std::function<size_t()>;
+
+  struct Config : DataReceiver::Config {
+    //! Policy for dropping messages when reconstruction falls behind
+    BackpressurePolicy::Config backpressure;
+  };
+
+  struct Stats {
+    size_t sensor_id = 0;
+    size_t queue_depth = 0;
+    size_t num_received = 0;
+    size_t num_dropped = 0;
+  };
+
+  RosDataReceiver(const Config& config, size_t sensor_id);
+
+  virtual ~RosDataReceiver();
+
+  /**
+   * @brief Hold packets in the gate until their pose is available (nullptr disables)
+   */
+  void setPacketGate(const TfPacketGate::Ptr& gate);
+
+  /**
+   * @brief Set how the backpressure policy measures the depth of the downstream queue
+   */
+  void setDownstreamDepth(const DepthFunction& depth);
+
+  Stats stats() const;
+
+  const BackpressurePolicy& backpressure() const { return backpressure_; }
+
+ protected:
+  /**
+   * @brief Run the backpressure policy for a new message
+   * @returns false if the message should be dropped without converting it
+   */
+  bool admitMessage(uint64_t timestamp_ns);
+
+  void pushPacket(const InputPacket::Ptr& packet);
+
+ private:
+  TfPacketGate::Ptr gate_;
+  DepthFunction downstream_depth_;
+  BackpressurePolicy backpressure_;
+};
+
+void declare_config(RosDataReceiver::Config& config);
+
+}  // namespace hydra
@@ -33,10 +33,16 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <hydra/input/input_module.h>
 #include <ros/ros.h>
 #include <tf2_ros/transform_listener.h>
 
+#include <optional>
+
+#include "hydra_ros/input/ros_data_receiver.h"
+#include "hydra_ros/input/tf_packet_gate.h"
+
 namespace hydra {
 
 class RosInputModule : public InputModule {
@@ -55,6 +61,12 @@ class RosInputModule : public InputModule {
     int tf_max_tries = 5;
     //! Logging verbosity of tf lookup process
     int tf_verbosity = 3;
+    //! Max time a packet waits for its pose before being dropped (<= 0 disables)
+    double tf_max_deferral_s = 1.0;
+    //! Look up the body pose once per camera batch (see ImageBatcher)
+    bool share_batch_pose = true;
+    //! Period for publishing queue depths and drop counts (<= 0 disables)
+    double diagnostics_period_s = 1.0;
   } const config;
 
   RosInputModule(const Config& config, const OutputQueue::Ptr& output_queue);
@@ -66,11 +78,19 @@ class RosInputModule : public InputModule {
  protected:
   PoseStatus getBodyPose(uint64_t timestamp_ns) override;
 
+  void publishDiagnostics(size_t reconstruction_depth);
+
  protected:
   ros::NodeHandle nh_;
   bool have_first_pose_;
+  //! Batch id and pose of the last batched packet
+  std::optional<std::pair<uint64_t, PoseStatus>> last_pose_;
   std::unique_ptr<tf2_ros::Buffer> buffer_;
   std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
+  TfPacketGate::Ptr tf_gate_;
+  std::vector<RosDataReceiver*> ros_receivers_;
+  ros::Publisher diagnostics_pub_;
+  ros::WallTimer diagnostics_timer_;
 
   inline static const auto registration_ = config::
       RegistrationWithConfig<InputModule, RosInputModule, Config, OutputQueue::Ptr>(
@@ -38,11 +38,16 @@
 
 #include <filesystem>
 
+#include "hydra_ros/input/image_decimator.h"
+
 namespace hydra {
 
 struct RosSensorExtrinsics : public SensorExtrinsics {
   struct Config {
     std::string sensor_frame = "";
+    //! Time budget for the lookup, shared with the camera info timeout (non-positive
+    //! waits until the camera info timer expires or forever if there is none)
+    double timeout_s = -1.0;
   };
 
   explicit RosSensorExtrinsics(const Config& config);
@@ -74,6 +79,15 @@ struct RosIntrinsicsRegistration {
 struct RosCameraIntrinsics {
   struct Config : Sensor::Config {
     std::string topic = "";
+    //! Cropping and decimation applied by the receiver (rescales the intrinsics)
+    ImageDecimator::Config decimation;
+    //! Time budget shared by all cameras waiting for camera info (non-positive waits
+    //! forever)
+    double timeout_s = -1.0;
+    //! File that stores received camera info between runs (disabled if empty)
+    std::string cache_path = "";
+    //! Use valid camera info from cache_path instead of waiting for the topic
+    bool use_cached = false;
   };
 
   static Camera::Config makeCameraConfig(const YAML::Node& data, const Config& config);
@@ -85,6 +99,9 @@ struct RosbagCameraIntrinsics {
   struct Config : Sensor::Config {
     std::string topic = "";
     std::filesystem::path bag_path;
+    //! Cropping and decimation applied by the bag reader or BagReceiver (rescales the
+    //! intrinsics)
+    ImageDecimator::Config decimation;
   };
 
   static Camera::Config makeCameraConfig(const YAML::Node& data, const Config& config);
@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/sensor_input_packet.h>
+#include <tf2/buffer_core.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace hydra {
+
+/**
+ * @brief Holds input packets until the transform at their timestamp is available
+ *
+ * Packets with an available transform are forwarded immediately, even if older packets
+ * are still waiting. Waiting packets are checked again whenever the tf buffer changes
+ * and are dropped once they are more than max_deferral_s older than the newest
+ * submitted packet.
+ */
+class TfPacketGate {
+ public:
+  using Ptr = std::shared_ptr<TfPacketGate>;
+  using Sink = std::function<void(const InputPacket::Ptr&)>;
+
+  TfPacketGate(tf2::BufferCore& buffer,
+               const std::string& target,
+               const std::string& source,
+               double max_deferral_s);
+
+  ~TfPacketGate();
+
+  /**
+   * @brief Forward the packet to the sink now or once its transform is available
+   */
+  void submit(const InputPacket::Ptr& packet, const Sink& sink);
+
+  /**
+   * @brief Forward every waiting packet whose transform is now available
+   */
+  void release();
+
+  /**
+   * @brief Stop listening to the tf buffer and forward future packets directly
+   */
+  void shutdown();
+
+  size_t numPending() const;
+
+  size_t numDropped() const;
+
+ private:
+  struct Pending {
+    InputPacket::Ptr packet;
+    Sink sink;
+  };
+
+  bool transformAvailable(uint64_t timestamp_ns) const;
+
+  void dropExpired();
+
+  tf2::BufferCore& buffer_;
+  const std::string target_;
+  const std::string source_;
+  const uint64_t max_deferral_ns_;
+
+  mutable std::mutex mutex_;
+  bool active_;
+  uint64_t newest_ns_;
+  size_t num_dropped_;
+  std::multimap<uint64_t, Pending> pending_;
+  boost::signals2::connection connection_;
+};
+
+}  // namespace hydra
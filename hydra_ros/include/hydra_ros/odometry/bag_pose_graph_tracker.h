@@ -0,0 +1,84 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+
+#include <config_utilities/factory.h>
+#include <hydra/odometry/pose_graph_tracker.h>
+
+#include <mutex>
+
+namespace hydra {
+
+/**
+ * @brief Odometry input for the offline pipeline
+ *
+ * Pose graphs read from a bag are added to a process-wide inbox that every tracker
+ * drains on update.
+ */
+class BagPoseGraphTracker : public PoseGraphTracker {
+ public:
+  struct Config {};
+
+  explicit BagPoseGraphTracker(const Config& config);
+  virtual ~BagPoseGraphTracker() = default;
+
+  PoseGraphPacket update(uint64_t timestamp,
+                         const Eigen::Isometry3d& world_T_body) override;
+
+  static void addPoseGraph(const pose_graph_tools::PoseGraph::ConstPtr& graph);
+
+  static void setExternalPriors(const pose_graph_tools::PoseGraph::ConstPtr& priors);
+
+  //! Drop anything that has not been consumed yet
+  static void reset();
+
+ private:
+  struct Inbox {
+    std::mutex mutex;
+    std::vector<pose_graph_tools::PoseGraph::ConstPtr> pose_graphs;
+    pose_graph_tools::PoseGraph::ConstPtr external_priors;
+  };
+
+  static Inbox& inbox();
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<PoseGraphTracker,
+                                     BagPoseGraphTracker,
+                                     BagPoseGraphTracker::Config>("BagPoseGraphs");
+};
+
+void declare_config(BagPoseGraphTracker::Config& config);
+
+}  // namespace hydra
@@ -35,8 +35,15 @@
 #include <hydra/common/output_sink.h>
 #include <sensor_msgs/Image.h>
 #include <hydra/input/input_data.h>
+#include <std_msgs/Header.h>
 
+#include <boost/shared_ptr.hpp>
 #include <filesystem>
+#include <opencv2/core.hpp>
+
+#include "hydra_ros/input/image_decimator.h"
+#include "hydra_ros/utils/decode_stage.h"
+#include "hydra_ros/utils/stamp_join.h"
 
 namespace hydra {
 
@@ -46,8 +53,11 @@ struct BagConfig {
   std::string depth_topic;
   double start = -1.0;
   double duration = -1.0;
+  //! Color topic contains sensor_msgs/CompressedImage (depth is detected per message)
   bool color_compressed = false;
   config::VirtualConfig<Sensor> sensor;
+  //! Cropping and decimation applied to every image (must match the sensor config)
+  ImageDecimator::Config decimation;
   std::string sensor_frame;
   std::string world_frame;
 };
@@ -56,12 +66,33 @@ void declare_config(BagConfig& config);
 
 class PoseCache;
 
+/**
+ * @brief Image read from a bag in the layout expected by InputData
+ *
+ * Raw images view the message buffer whenever possible, compressed images are decoded
+ * directly into the image (color images as RGB).
+ */
+struct BagImage {
+  using Ptr = boost::shared_ptr<BagImage>;
+  using ConstPtr = boost::shared_ptr<const BagImage>;
+
+  std_msgs::Header header;
+  cv::Mat image;
+};
+
 class BagReader {
  public:
   using Sink = OutputSink<const InputData&>;
   struct Config {
     std::vector<BagConfig> bags;
     std::vector<Sink::Factory> sinks;
+    //! Threads used to decode (compressed) images
+    DecodeStage::Config decoding;
+    //! Threads used to look up poses and normalize frames before the sinks
+    DecodeStage::Config processing;
+    //! Pair color and depth by header stamp instead of approximate time sync
+    bool use_stamp_join = false;
+    StampJoinConfig stamp_join;
   } const config;
 
   explicit BagReader(const Config& config);
@@ -78,7 +109,19 @@ class BagReader {
                     const sensor_msgs::Image::ConstPtr& color_msg,
                     const sensor_msgs::Image::ConstPtr& depth_msg);
 
+  /**
+   * @brief Look up the pose and build normalized input data for a frame
+   * @returns The input data or nullptr if the frame is invalid
+   */
+  std::shared_ptr<InputData> makeInputData(const BagConfig& bag_config,
+                                           const Sensor::ConstPtr& sensor,
+                                           const PoseCache& cache,
+                                           const BagImage::ConstPtr& color,
+                                           const BagImage::ConstPtr& depth) const;
+
  protected:
+  friend struct Trampoline;
+
   void readBag(const BagConfig& config);
 
   Sink::List sinks_;
@@ -0,0 +1,175 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/input_module.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <sensor_msgs/CameraInfo.h>
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Waits for the first camera info message on many topics at once
+ *
+ * Sensors are created one at a time, so waiting on each camera info topic in turn
+ * makes startup take the sum of every topic's first-message latency. The prefetcher
+ * subscribes to every topic up front on its own callback queue (serviced by a
+ * dedicated spinner), so waiting for all sensors takes as long as the slowest one.
+ * Sensor extrinsics are looked up the same way, one thread per sensor frame.
+ */
+class CameraInfoPrefetcher {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Deadline = std::optional<Clock::time_point>;
+
+  static CameraInfoPrefetcher& instance();
+
+  ~CameraInfoPrefetcher();
+
+  /**
+   * @brief Subscribe to every topic that has not been requested yet
+   * @param nh Node handle topics are resolved against
+   * @param timeout_s Overall time budget for all requested topics (non-positive to wait
+   * forever). Only the first call that sets a timeout starts the clock.
+   */
+  void prefetch(const ros::NodeHandle& nh,
+                const std::vector<std::string>& topics,
+                double timeout_s = -1.0);
+
+  /**
+   * @brief Wait for the first message on the topic
+   * @returns The message or nullptr if the overall timeout expired, ros shut down or
+   * waits were interrupted
+   */
+  sensor_msgs::CameraInfo::ConstPtr wait(const ros::NodeHandle& nh,
+                                         const std::string& topic,
+                                         double timeout_s = -1.0);
+
+  /**
+   * @brief Start looking up every sensor frame that has not been requested yet
+   * @param target Frame the extrinsics are expressed in (i.e., the robot frame)
+   * @param frames Sensor frames to look up
+   * @param timeout_s Overall time budget shared with the camera info (see prefetch)
+   */
+  void prefetchExtrinsics(const std::string& target,
+                          const std::vector<std::string>& frames,
+                          double timeout_s = -1.0);
+
+  /**
+   * @brief Wait for the transform from the sensor frame to the target frame
+   * @returns The transform or an invalid status if the overall timeout expired, ros
+   * shut down or waits were interrupted
+   */
+  PoseStatus waitExtrinsics(const std::string& target,
+                            const std::string& frame,
+                            double timeout_s = -1.0);
+
+  /**
+   * @brief Drop all subscriptions, stop the spinner and wait for pending lookups
+   */
+  void reset();
+
+  /**
+   * @brief Start the overall startup timer if it has not been started yet
+   * @param timeout_s Time budget (non-positive leaves the timer unchanged)
+   * @returns The deadline shared by every sensor waiting during startup (if any)
+   */
+  Deadline startTimer(double timeout_s);
+
+ private:
+  CameraInfoPrefetcher() = default;
+
+  struct Request {
+    ros::Subscriber sub;
+    std::promise<sensor_msgs::CameraInfo::ConstPtr> promise;
+    std::shared_future<sensor_msgs::CameraInfo::ConstPtr> result;
+    std::once_flag received;
+  };
+
+  using FrameKey = std::pair<std::string, std::string>;
+
+  std::shared_ptr<Request> request(const ros::NodeHandle& nh, const std::string& topic);
+
+  std::shared_future<PoseStatus> requestExtrinsics(const std::string& target,
+                                                   const std::string& frame);
+
+  std::mutex mutex_;
+  ros::CallbackQueue queue_;
+  std::unique_ptr<ros::AsyncSpinner> spinner_;
+  std::map<std::string, std::shared_ptr<Request>> requests_;
+  std::map<FrameKey, std::shared_future<PoseStatus>> extrinsics_;
+  Deadline deadline_;
+};
+
+/**
+ * @brief Find every camera_info_topic configured for a "camera_info" sensor
+ *
+ * Searches the parameter tree under the node handle namespace.
+ */
+std::vector<std::string> findCameraInfoTopics(const ros::NodeHandle& nh);
+
+/**
+ * @brief Find every sensor_frame configured for "ros" extrinsics
+ *
+ * Searches the parameter tree under the node handle namespace.
+ */
+std::vector<std::string> findSensorFrames(const ros::NodeHandle& nh);
+
+/**
+ * @brief Read camera info for a topic stored by a previous run
+ * @returns The cached message if present and marked valid
+ */
+sensor_msgs::CameraInfo::ConstPtr readCachedCameraInfo(
+    const std::filesystem::path& cache_path, const std::string& topic);
+
+/**
+ * @brief Store the camera info for a topic so the next run can skip waiting for it
+ */
+bool writeCachedCameraInfo(const std::filesystem::path& cache_path,
+                           const std::string& topic,
+                           const sensor_msgs::CameraInfo& msg);
+
+}  // namespace hydra
@@ -0,0 +1,65 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <opencv2/core.hpp>
+
+namespace hydra {
+
+/**
+ * @brief Decode a compressed image (JPEG/PNG or compressedDepth) with OpenCV
+ *
+ * Depth images published by compressed_depth_image_transport are returned as 16UC1 or
+ * 32FC1 (with invalid pixels set to NaN). Color images are returned as RGB if to_rgb
+ * is set, and otherwise in the channel order they were published with (e.g., RGB for
+ * "rgb8; jpeg compressed bgr8", as for raw images) or BGR if the format does not say.
+ *
+ * @returns The decoded image or an empty image if the message could not be decoded
+ */
+cv::Mat decodeCompressedImage(const sensor_msgs::CompressedImage& msg,
+                              bool to_rgb = false);
+
+/**
+ * @brief Decode a compressed image into an uncompressed message with the same header
+ * @returns The decoded message or nullptr if the message could not be decoded
+ */
+sensor_msgs::Image::Ptr decompressImageMessage(const sensor_msgs::CompressedImage& msg);
+
+//! Whether the message was published by compressed_depth_image_transport
+bool isCompressedDepth(const sensor_msgs::CompressedImage& msg);
+
+}  // namespace hydra
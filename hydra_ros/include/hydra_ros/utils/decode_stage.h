@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "hydra_ros/utils/worker_pool.h"
+
+namespace hydra {
+
+/**
+ * @brief Runs decode tasks in parallel and delivers their results in timestamp order
+ *
+ * Each task runs on a worker thread and returns a continuation (e.g., pushing a packet
+ * to a queue). Continuations are run one at a time, ordered by timestamp (and by
+ * submission order for equal timestamps), as soon as every earlier task has finished.
+ * The number of tasks in flight is bounded; submit blocks while the stage is full.
+ */
+class DecodeStage {
+ public:
+  using Continuation = std::function<void()>;
+  using Task = std::function<Continuation()>;
+
+  struct Config {
+    //! Number of decoding threads
+    size_t num_threads = 2;
+    //! Maximum number of tasks being decoded or waiting to be delivered
+    size_t max_pending = 8;
+  } const config;
+
+  struct Stats {
+    //! Number of tasks that finished running
+    size_t num_tasks = 0;
+    //! Total time spent running tasks (summed over threads)
+    double task_s = 0.0;
+    //! Number of continuations delivered
+    size_t num_delivered = 0;
+    //! Total time spent running continuations
+    double delivery_s = 0.0;
+  };
+
+  explicit DecodeStage(const Config& config);
+
+  ~DecodeStage();
+
+  DecodeStage(const DecodeStage& other) = delete;
+
+  DecodeStage& operator=(const DecodeStage& other) = delete;
+
+  void submit(uint64_t timestamp_ns, const Task& task);
+
+  //! Block until every submitted task has been delivered
+  void flush();
+
+  size_t numPending() const;
+
+  Stats stats() const;
+
+ private:
+  using Key = std::pair<uint64_t, size_t>;
+
+  struct Result {
+    bool done = false;
+    Continuation continuation;
+  };
+
+  void finish(const Key& key, Continuation&& continuation);
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t num_submitted_;
+  bool delivering_;
+  std::map<Key, Result> pending_;
+  Stats stats_;
+  // declared last so workers are joined before anything they use is destroyed
+  std::unique_ptr<WorkerPool> pool_;
+};
+
+void declare_config(DecodeStage::Config& config);
+
+}  // namespace hydra
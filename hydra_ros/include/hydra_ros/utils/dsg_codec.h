@@ -0,0 +1,91 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+//! Compression applied to serialized scene graphs (values match hydra_msgs/DsgUpdate)
+enum class DsgCodec : uint8_t {
+  NONE = 0,
+  ZSTD = 1,
+  LZ4 = 2,
+};
+
+//! Largest uncompressed size accepted from a message (guards against corrupt sizes)
+constexpr size_t kMaxDsgPayloadSize = size_t(1) << 31;
+
+/**
+ * @brief Parse a codec name ('none', 'zstd' or 'lz4')
+ * @returns The codec or NONE if the name is invalid
+ */
+DsgCodec parseDsgCodec(const std::string& name);
+
+std::string toString(DsgCodec codec);
+
+//! Whether support for the codec was compiled in
+bool hasDsgCodec(DsgCodec codec);
+
+//! Default level for the codec (zstd: 3, lz4: 1 for the fast compressor)
+int defaultDsgCompressionLevel(DsgCodec codec);
+
+/**
+ * @brief Compress a serialized scene graph
+ *
+ * Levels follow each library (zstd: 1-22, lz4: 1 or less uses the fast compressor and
+ * values above 1 select the much slower HC compressor).
+ * @returns True if the payload was compressed
+ */
+bool compressDsg(DsgCodec codec,
+                 int level,
+                 const std::vector<uint8_t>& input,
+                 std::vector<uint8_t>& output);
+
+/**
+ * @brief Decompress a serialized scene graph
+ *
+ * Rejects sizes above kMaxDsgPayloadSize and (for zstd) sizes that do not match the
+ * frame header before allocating any memory.
+ * @returns True if the payload was decompressed to exactly uncompressed_size bytes
+ */
+bool decompressDsg(DsgCodec codec,
+                   const std::vector<uint8_t>& input,
+                   size_t uncompressed_size,
+                   std::vector<uint8_t>& output);
+
+}  // namespace hydra
@@ -0,0 +1,128 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+struct DsgDelta {
+  //! New and changed nodes and edges (plus the endpoints of every changed edge)
+  DynamicSceneGraph::Ptr graph;
+  std::vector<NodeId> deleted_nodes;
+  std::vector<std::pair<NodeId, NodeId>> deleted_edges;
+};
+
+/**
+ * @brief Tracks the scene graph a subscriber last received to compute delta updates
+ *
+ * Keeps a copy of the attributes of every node and edge that has been sent. Changed
+ * dynamic nodes are inserted at their own index in the delta (and by applyDelta), so
+ * only the nodes that changed or were appended are sent.
+ */
+class DsgDeltaTracker {
+ public:
+  //! Record that the entire graph was sent
+  void reset(const DynamicSceneGraph& graph);
+
+  //! Compute every change since the last update (or reset) and record it as sent
+  DsgDelta update(const DynamicSceneGraph& graph);
+
+  inline size_t numNodes() const { return nodes_.size(); }
+
+  inline size_t numEdges() const { return edges_.size(); }
+
+ private:
+  using EdgeKey = std::pair<NodeId, NodeId>;
+
+  std::unordered_map<NodeId, NodeAttributes::Ptr> nodes_;
+  std::map<EdgeKey, EdgeAttributes::Ptr> edges_;
+};
+
+/**
+ * @brief Decides which received updates can be applied from their sequence numbers
+ *
+ * A delta can only be applied on top of every previous message, so after a missed
+ * message (or an update that could not be applied) deltas are dropped until the next
+ * keyframe.
+ */
+class DsgSequenceTracker {
+ public:
+  enum class Action {
+    APPLY,
+    DROP,
+    //! Drop the update and ask the sender for a keyframe (once per gap)
+    DROP_AND_REQUEST_KEYFRAME,
+  };
+
+  Action receive(int64_t sequence_number, bool full_update);
+
+  //! Record that an update was not applied (drops deltas until the next keyframe)
+  inline void markFailed() { waiting_for_keyframe_ = true; }
+
+  inline bool waitingForKeyframe() const { return waiting_for_keyframe_; }
+
+ private:
+  std::optional<int64_t> last_sequence_number_;
+  bool has_keyframe_ = false;
+  bool waiting_for_keyframe_ = false;
+};
+
+/**
+ * @brief Apply a delta computed by a DsgDeltaTracker
+ *
+ * Requires that the graph matches the graph the delta was computed against.
+ */
+void applyDelta(DynamicSceneGraph& graph,
+                const DynamicSceneGraph& delta,
+                const std::vector<NodeId>& deleted_nodes,
+                const std::vector<std::pair<NodeId, NodeId>>& deleted_edges);
+
+/**
+ * @brief Copy the nodes and edges of a subset of layers of the graph
+ *
+ * Interlayer edges are kept if both layers are selected. The result keeps the layer
+ * ids of the original graph and does not include the mesh.
+ */
+DynamicSceneGraph::Ptr extractLayers(const DynamicSceneGraph& graph,
+                                     const std::set<LayerId>& layers);
+
+}  // namespace hydra
@@ -35,13 +35,42 @@
 #pragma once
 #include <hydra/common/dsg_types.h>
 #include <hydra_msgs/DsgUpdate.h>
+#include <hydra_msgs/GetDsg.h>
 #include <kimera_pgmo_msgs/KimeraPgmoMesh.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
+#include <std_msgs/Empty.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <memory>
 #include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "hydra_ros/utils/dsg_codec.h"
+#include "hydra_ros/utils/dsg_delta.h"
+#include "hydra_ros/utils/latest_mailbox.h"
 
 namespace hydra {
 
+/**
+ * @brief Publishes a scene graph as a stream of keyframes and deltas
+ *
+ * The entire graph is published on 'dsg'. Consumers that only need some layers can
+ * subscribe to a profile instead, declared via the 'dsg_profiles' param, e.g.,
+ *
+ *   dsg_profiles:
+ *     planner: {layers: [3, 4], include_mesh: false}
+ *
+ * publishes the objects and rooms on 'dsg/planner'. Profiles that select the same
+ * layers share a single serialized message per update.
+ *
+ * The 'get_dsg' service returns a snapshot of the latest graph on demand, so the
+ * graph is only serialized when requested if nothing subscribes to the topics.
+ */
 class DsgSender {
  public:
   explicit DsgSender(const ros::NodeHandle& nh,
@@ -51,25 +80,118 @@ class DsgSender {
                      double min_mesh_separation_s = 0.0,
                      bool serialize_dsg_mesh_ = true);
 
+  ~DsgSender();
+
+  DsgSender(const DsgSender& other) = delete;
+
+  DsgSender& operator=(const DsgSender& other) = delete;
+
+  /**
+   * @brief Queue a snapshot of the graph to be published
+   *
+   * Serialization and publishing happen on a separate thread. If that thread falls
+   * behind, only the most recent snapshot is published. The last snapshot is still
+   * published when the sender is destroyed.
+   */
   void sendGraph(const DynamicSceneGraph& graph, const ros::Time& stamp) const;
 
+  //! Number of snapshots replaced by a newer one before they were published
+  size_t numCoalesced() const;
+
  private:
+  struct Snapshot {
+    DynamicSceneGraph::Ptr graph;
+    ros::Time stamp;
+  };
+
+  //! Publishers that receive the same subset of the graph
+  struct Stream {
+    //! Layers to send (every layer if empty)
+    std::set<LayerId> layers;
+    bool include_mesh = true;
+    std::vector<ros::Publisher> pubs;
+    std::vector<ros::Subscriber> keyframe_subs;
+    std::atomic<bool> keyframe_requested{false};
+    int64_t sequence_number = 0;
+    int updates_since_keyframe = 0;
+    uint32_t last_num_subscribers = 0;
+    DsgDeltaTracker tracker;
+
+    uint32_t numSubscribers() const;
+  };
+
+  void spin();
+
+  //! Publish every stream with subscribers and the mesh
+  void publish(const DynamicSceneGraph& graph, const ros::Time& stamp);
+
+  /**
+   * @brief Serialize and publish the graph to a stream
+   *
+   * Sends the entire graph every 'dsg_keyframe_period' updates, when a subscriber
+   * connects or when a keyframe is requested, and only changes since the last message
+   * otherwise (the default period of 0 always sends the entire graph).
+   */
+  void publishStream(Stream& stream,
+                     const DynamicSceneGraph& graph,
+                     const ros::Time& stamp);
+
+  void advertise(Stream& stream, const std::string& topic);
+
+  //! Compress the serialized graph into the message if a codec is configured
+  void setContents(std::vector<uint8_t>&& payload, hydra_msgs::DsgUpdate& msg) const;
+
+  /**
+   * @brief Serialize the latest graph for the 'get_dsg' service
+   *
+   * Waits up to 'dsg_snapshot_timeout_s' for the next update if the graph was not
+   * copied on the last update, and falls back to the last copy otherwise. Runs on its
+   * own callback queue so that waiting never blocks other callbacks.
+   */
+  bool handleGetDsg(hydra_msgs::GetDsg::Request& req,
+                    hydra_msgs::GetDsg::Response& res);
+
+  void loadProfiles();
+
   ros::NodeHandle nh_;
   std::string frame_id_;
 
-  ros::Publisher pub_;
   ros::Publisher mesh_pub_;
-  mutable std::optional<uint64_t> last_mesh_time_ns_;
+  std::optional<uint64_t> last_mesh_time_ns_;
 
   std::string timer_name_;
   bool publish_mesh_;
   double min_mesh_separation_s_;
   bool serialize_dsg_mesh_;
+
+  int keyframe_period_;
+  DsgCodec codec_;
+  int compression_level_;
+  double snapshot_timeout_s_;
+  //! The entire graph followed by each distinct profile
+  std::vector<std::unique_ptr<Stream>> streams_;
+
+  // mailbox between sendGraph and the publishing thread
+  mutable LatestMailbox<Snapshot> mailbox_;
+
+  // most recent copy of the graph, shared with the publishing thread and never modified
+  mutable std::mutex mutex_;
+  mutable Snapshot latest_;
+  mutable bool latest_is_current_;
+  mutable std::atomic<bool> snapshot_requested_;
+  mutable std::condition_variable snapshot_cv_;
+  std::thread thread_;
+
+  // declared after the state the service uses so that it is destroyed first
+  ros::CallbackQueue snapshot_queue_;
+  std::unique_ptr<ros::AsyncSpinner> snapshot_spinner_;
+  ros::ServiceServer snapshot_srv_;
 };
 
 class DsgReceiver {
  public:
-  using LogCallback = std::function<void(const ros::Time&, size_t)>;
+  //! Called with the stamp, message size and uncompressed payload size of each update
+  using LogCallback = std::function<void(const ros::Time&, size_t, size_t)>;
 
   explicit DsgReceiver(const ros::NodeHandle& nh, bool subscribe_to_mesh = false);
 
@@ -84,13 +206,19 @@ class DsgReceiver {
  private:
   void handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg);
 
+  bool applyUpdate(const hydra_msgs::DsgUpdate& msg);
+
+  void requestKeyframe();
+
   void handleMesh(const kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr& msg);
 
   ros::NodeHandle nh_;
   ros::Subscriber sub_;
   ros::Subscriber mesh_sub_;
+  ros::Publisher keyframe_pub_;
 
   bool has_update_;
+  DsgSequenceTracker sequence_;
   DynamicSceneGraph::Ptr graph_;
   Mesh::Ptr mesh_;
 
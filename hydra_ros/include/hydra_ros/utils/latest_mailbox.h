@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+
+namespace hydra {
+
+/**
+ * @brief Single-slot mailbox that only keeps the most recent value
+ *
+ * Producers never block: a value that has not been taken yet is replaced (and counted
+ * as coalesced). Values that are still pending when the mailbox shuts down are handed
+ * out before take() reports shutdown.
+ */
+template <typename T>
+class LatestMailbox {
+ public:
+  LatestMailbox() : num_coalesced_(0), should_shutdown_(false) {}
+
+  /**
+   * @brief Replace the pending value
+   * @returns True if a value that was never taken was replaced
+   */
+  bool put(T&& value) {
+    bool coalesced = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      coalesced = pending_.has_value();
+      if (coalesced) {
+        ++num_coalesced_;
+      }
+
+      pending_ = std::move(value);
+    }
+
+    cv_.notify_one();
+    return coalesced;
+  }
+
+  /**
+   * @brief Wait for the next value
+   * @returns The value or nothing once the mailbox is shut down and empty
+   */
+  std::optional<T> take() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return should_shutdown_ || pending_; });
+    std::optional<T> value;
+    value.swap(pending_);
+    return value;
+  }
+
+  //! Wake up take() once the pending value (if any) is taken
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      should_shutdown_ = true;
+    }
+
+    cv_.notify_all();
+  }
+
+  size_t numCoalesced() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_coalesced_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::optional<T> pending_;
+  size_t num_coalesced_;
+  bool should_shutdown_;
+};
+
+}  // namespace hydra
@@ -47,7 +47,7 @@ PoseStatus lookupTransform(const std::string& target,
                            double wait_duration_s = 0.1,
                            int verbosity = 10);
 
-// TODO(nathan) early shutdown...
+// stops early if waits are interrupted (see interruptWaits)
 PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
                            const std::optional<ros::Time>& stamp,
                            const std::string& target,
@@ -38,8 +38,15 @@
 #include <ros/ros.h>
 #include <std_srvs/Empty.h>
 
+#include <stdexcept>
+
 namespace hydra {
 
+//! Thrown when sensor setup gives up because waits were interrupted
+struct InitInterrupted : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
 struct ServiceFunctor {
   ServiceFunctor() : should_exit(false) {}
 
@@ -59,4 +66,33 @@ void spinUntilExitRequested();
 
 void spinAndWait(const ros::NodeHandle& nh);
 
+/**
+ * @brief Set the node handle that private names ("~") resolve against
+ *
+ * Inside a nodelet, "~" would otherwise resolve to the nodelet manager and callbacks
+ * would be queued on the global callback queue instead of the nodelet queue.
+ */
+void setPrivateNodeHandle(const ros::NodeHandle& nh);
+
+/**
+ * @brief Get a node handle for a namespace
+ *
+ * Equivalent to ros::NodeHandle(ns) unless setPrivateNodeHandle was called, in which
+ * case names are resolved relative to the registered handle and share its callback
+ * queue.
+ */
+ros::NodeHandle getNodeHandle(const std::string& ns);
+
+/**
+ * @brief Make blocking startup waits (camera info, tf) return early
+ *
+ * ros::ok() stays true while a nodelet is unloaded, so waits also check this flag.
+ */
+void interruptWaits(bool interrupt = true);
+
+/**
+ * @brief Whether blocking waits should continue (ros is running and not interrupted)
+ */
+bool keepWaiting();
+
 }  // namespace hydra
@@ -0,0 +1,129 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spark_dsg/mesh.h>
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Streams meshes to a binary PLY file while welding duplicate vertices
+ *
+ * Vertices are written as soon as a mesh is added and faces are spooled to a temporary
+ * file next to the output. Vertices within weld_resolution of each other (after
+ * quantization) are merged, which connects the meshes of neighboring blocks.
+ *
+ * If the meshes are blocks of a grid with side length block_size, only vertices within
+ * boundary_width of a block face can be shared with another block, so only those are
+ * kept in the index across meshes (everything else is only welded within its block).
+ * Without a block size, every vertex stays indexed until finish().
+ */
+class PlyMeshWriter {
+ public:
+  PlyMeshWriter(const std::filesystem::path& path,
+                double weld_resolution = 1.0e-4,
+                double block_size = 0.0,
+                double boundary_width = 0.0);
+
+  ~PlyMeshWriter();
+
+  PlyMeshWriter(const PlyMeshWriter& other) = delete;
+
+  PlyMeshWriter& operator=(const PlyMeshWriter& other) = delete;
+
+  //! Append a mesh (e.g., a single mesh block)
+  void addMesh(const spark_dsg::Mesh& mesh);
+
+  /**
+   * @brief Write faces and fill in the element counts
+   * @returns True if the file was written successfully
+   */
+  bool finish();
+
+  inline size_t numVertices() const { return num_vertices_; }
+
+  inline size_t numFaces() const { return num_faces_; }
+
+  //! Number of input vertices merged into an existing vertex
+  inline size_t numWelded() const { return num_welded_; }
+
+  //! Number of vertices currently indexed for welding across meshes
+  inline size_t numIndexed() const { return index_.size(); }
+
+ private:
+  struct Key {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+
+    inline bool operator==(const Key& other) const {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  using Index = std::unordered_map<Key, uint32_t, KeyHash>;
+
+  //! Whether a vertex may be shared with another block
+  bool onBoundary(const Eigen::Vector3f& pos) const;
+
+  const std::filesystem::path path_;
+  const std::filesystem::path faces_path_;
+  const double inv_resolution_;
+  const double block_size_;
+  const double boundary_width_;
+  bool finished_;
+  std::ofstream out_;
+  std::ofstream faces_;
+  std::streampos vertex_count_pos_;
+  std::streampos face_count_pos_;
+  size_t num_vertices_;
+  size_t num_faces_;
+  size_t num_welded_;
+  //! Vertices that can be welded across meshes
+  Index index_;
+  //! Remaining vertices of the current mesh
+  Index block_index_;
+  std::vector<uint32_t> remap_;
+};
+
+}  // namespace hydra
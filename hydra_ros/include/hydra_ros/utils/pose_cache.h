@@ -38,6 +38,8 @@
 #include <Eigen/Geometry>
 #include <filesystem>
 
+#include "hydra_ros/utils/pose_timeline.h"
+
 namespace rosbag {
 class Bag;
 }
@@ -46,9 +48,18 @@ namespace hydra {
 
 class PoseCache {
  public:
+  enum class Backend {
+    TIMELINE,  //!< compact sorted timelines per frame pair (default)
+    TF2,       //!< full tf2::BufferCore
+  };
+
   struct Config {
     std::filesystem::path bag_path;
     bool static_only = false;
+    //! Either "timeline" or "tf2"
+    std::string backend = "timeline";
+    //! Map (or create) a pose index next to the bag instead of scanning the bag
+    bool use_index = true;
   };
 
   struct PoseResult {
@@ -65,14 +76,29 @@ class PoseCache {
 
   explicit PoseCache(const Config& config);
 
-  explicit PoseCache(const rosbag::Bag& bag, bool static_only = false);
+  /**
+   * @brief Load poses from an open bag
+   * @param use_index Map the pose index next to the bag if it is up to date or write
+   * it after scanning the bag otherwise (timeline backend only)
+   */
+  explicit PoseCache(const rosbag::Bag& bag,
+                     bool static_only = false,
+                     Backend backend = Backend::TIMELINE,
+                     bool use_index = true);
+
+  //! Path of the pose index for a bag
+  static std::filesystem::path indexPath(const std::filesystem::path& bag_path,
+                                         bool static_only);
 
   PoseResult lookupPose(uint64_t timestamp_ns,
                         const std::string& to_frame,
                         const std::string& from_frame) const;
 
  private:
+  void fill(const rosbag::Bag& bag, bool static_only, Backend backend, bool use_index);
+
   std::shared_ptr<tf2::BufferCore> buffer_;
+  std::shared_ptr<PoseTimeline> timeline_;
 };
 
 void declare_config(PoseCache::Config& config);
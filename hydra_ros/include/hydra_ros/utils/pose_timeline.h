@@ -0,0 +1,186 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Compact, time-sorted storage of a transform tree for offline pose lookups
+ *
+ * Every edge of the tree stores its samples in contiguous arrays (timestamps,
+ * positions and float rotations). The chain of edges between a pair of frames is
+ * resolved the first time the pair is requested; chains with at most one dynamic edge
+ * are flattened into a single timeline so that later lookups are one binary search
+ * and one interpolation. Lookups never throw and are safe to call from multiple
+ * threads once finalize() has been called.
+ *
+ * A finalized timeline can be written to an index file that later runs map directly
+ * instead of rebuilding the timeline from the source bag.
+ */
+class PoseTimeline {
+ public:
+  enum class Status {
+    VALID,          //!< pose was found
+    UNKNOWN_FRAME,  //!< one of the frames is not part of the tree
+    NOT_CONNECTED,  //!< the frames are in disjoint trees
+    EXTRAPOLATION,  //!< the timestamp is outside the recorded range
+  };
+
+  struct Pose {
+    Eigen::Vector3d to_p_from = Eigen::Vector3d::Zero();
+    Eigen::Quaterniond to_R_from = Eigen::Quaterniond::Identity();
+  };
+
+  //! Identifies the data an index file was built from
+  struct IndexKey {
+    uint64_t source_size = 0;
+    int64_t source_mtime_ns = 0;
+    bool static_only = false;
+
+    static IndexKey fromFile(const std::filesystem::path& path, bool static_only);
+  };
+
+  /**
+   * @brief Add a sample of parent_T_child
+   *
+   * Samples can be added in any order. Static edges keep the latest sample added.
+   */
+  void add(const std::string& parent,
+           const std::string& child,
+           uint64_t timestamp_ns,
+           const Eigen::Vector3d& parent_p_child,
+           const Eigen::Quaterniond& parent_R_child,
+           bool is_static = false);
+
+  //! Sort and compact all samples. Must be called before any lookups
+  void finalize();
+
+  /**
+   * @brief Look up to_T_from at the requested time
+   * @param timestamp_ns Lookup time, where 0 means the latest time available
+   */
+  Status lookup(uint64_t timestamp_ns,
+                const std::string& to_frame,
+                const std::string& from_frame,
+                Pose& pose) const;
+
+  size_t numEdges() const { return edges_.size(); }
+
+  size_t numSamples() const;
+
+  /**
+   * @brief Write the finalized timeline to an index file
+   * @returns False if the file could not be written
+   */
+  bool writeIndex(const std::filesystem::path& path, const IndexKey& key) const;
+
+  /**
+   * @brief Map an index file written by writeIndex
+   * @returns The timeline or nullptr if the file is missing, invalid or stale
+   */
+  static std::shared_ptr<PoseTimeline> mapIndex(const std::filesystem::path& path,
+                                                const IndexKey& key);
+
+ private:
+  struct Timeline {
+    bool is_static = false;
+    //! Owned samples (empty when the timeline is mapped from an index)
+    std::vector<uint64_t> stamps;
+    std::vector<double> positions;
+    std::vector<float> rotations;
+    //! Views of the samples used for lookups
+    size_t num_samples = 0;
+    const uint64_t* stamp_data = nullptr;
+    const double* position_data = nullptr;
+    const float* rotation_data = nullptr;
+
+    size_t size() const { return num_samples; }
+    void push(uint64_t stamp, const Pose& pose);
+    void finalize();
+    //! Point the views at the owned samples
+    void bind();
+    Status interpolate(uint64_t timestamp_ns, Pose& pose) const;
+  };
+
+  struct Edge {
+    std::string parent;
+    Timeline timeline;
+  };
+
+  struct Step {
+    const Timeline* timeline;
+    bool inverse;
+  };
+
+  struct Chain {
+    Status status = Status::VALID;
+    //! Steps applied from left to right. Empty if the chain is flattened
+    std::vector<Step> steps;
+    Timeline flattened;
+    uint64_t latest_ns = 0;
+
+    Status evaluate(uint64_t timestamp_ns, Pose& pose) const;
+  };
+
+  using ChainKey = std::pair<std::string, std::string>;
+
+  std::shared_ptr<const Chain> getChain(const std::string& to_frame,
+                                        const std::string& from_frame) const;
+  std::shared_ptr<const Chain> makeChain(const std::string& to_frame,
+                                         const std::string& from_frame) const;
+  std::vector<std::string> getAncestors(const std::string& frame) const;
+
+  //! Keeps an index file mapped while the timeline is alive
+  std::shared_ptr<void> mapping_;
+  std::unordered_set<std::string> frames_;
+  std::unordered_map<std::string, Edge> edges_;
+  mutable std::mutex mutex_;
+  mutable std::map<ChainKey, std::shared_ptr<const Chain>> chains_;
+};
+
+std::ostream& operator<<(std::ostream& out, PoseTimeline::Status status);
+
+}  // namespace hydra
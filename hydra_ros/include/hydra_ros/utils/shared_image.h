@@ -0,0 +1,78 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <cv_bridge/cv_bridge.h>
+#include <sensor_msgs/Image.h>
+
+#include <opencv2/core.hpp>
+
+namespace hydra {
+
+/**
+ * @brief Result of viewing a ROS image as a cv::Mat
+ */
+struct ImageView {
+  //! Image contents (either aliasing the message buffer or a converted copy)
+  cv::Mat image;
+  //! Number of bytes that had to be copied or converted to produce the image
+  size_t bytes_copied = 0;
+
+  inline bool shared() const { return bytes_copied == 0; }
+};
+
+/**
+ * @brief Get a cv::Mat that aliases the message buffer whenever possible
+ *
+ * If the message encoding matches the requested encoding (or no encoding is
+ * requested), the returned image points directly into the message data and holds a
+ * reference to the message, so it stays valid even after all other references to the
+ * message are dropped. Otherwise the image is converted (and therefore copied).
+ *
+ * Note that an aliased image shares memory with every other subscriber of the same
+ * message in this process and should be treated as read-only.
+ *
+ * @throws cv_bridge::Exception if the encoding conversion is not possible
+ */
+ImageView viewImage(const sensor_msgs::Image::ConstPtr& msg,
+                    const std::string& encoding = "");
+
+/**
+ * @brief Attach the lifetime of an owner to a cv::Mat that views external memory
+ *
+ * Images that already own their memory are returned as-is.
+ */
+cv::Mat shareImage(const cv::Mat& view, const std::shared_ptr<const void>& owner);
+
+}  // namespace hydra
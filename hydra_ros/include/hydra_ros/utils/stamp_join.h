@@ -0,0 +1,209 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+struct StampJoinConfig {
+  //! Maximum difference between paired stamps [ns] (0 only pairs identical stamps)
+  uint64_t tolerance_ns = 0;
+  //! Unpaired messages kept per input before the oldest are dropped
+  size_t max_pending = 100;
+};
+
+void declare_config(StampJoinConfig& config);
+
+/**
+ * @brief Pairs messages from two inputs by header stamp with a hash join
+ *
+ * Stamps are bucketed into windows of tolerance_ns + 1 nanoseconds, so a lookup only
+ * has to check the matching bucket and its two neighbors (just the matching bucket for
+ * exact stamps). Each message is paired with the closest unpaired message from the
+ * other input as soon as it arrives, regardless of the order the inputs are
+ * interleaved in. Messages that are never paired are dropped and counted.
+ */
+template <typename T>
+class StampJoin {
+ public:
+  using Config = StampJoinConfig;
+  using Callback = std::function<void(const T&, const T&)>;
+
+  struct Stats {
+    size_t num_matched = 0;
+    //! Number of dropped messages per input
+    std::array<size_t, 2> num_unmatched{{0, 0}};
+  };
+
+  StampJoin(const Config& config, const Callback& callback)
+      : config(config), callback_(callback), num_added_(0) {}
+
+  /**
+   * @brief Add a message to input 0 or 1
+   *
+   * Calls the callback (with the input 0 message first) if the message completes a
+   * pair.
+   */
+  void add(size_t input, uint64_t stamp_ns, const T& msg);
+
+  //! Drop every unpaired message
+  void flush();
+
+  inline size_t numPending(size_t input) const { return order_.at(input).size(); }
+
+  inline const Stats& stats() const { return stats_; }
+
+  const Config config;
+
+ private:
+  struct Entry {
+    uint64_t stamp_ns;
+    size_t id;
+    T msg;
+  };
+
+  using Buckets = std::unordered_map<uint64_t, std::vector<Entry>>;
+
+  inline uint64_t bucket(uint64_t stamp_ns) const {
+    return stamp_ns / (config.tolerance_ns + 1);
+  }
+
+  bool take(size_t input, uint64_t stamp_ns, T& msg);
+
+  void erase(size_t input, uint64_t stamp_ns, size_t id);
+
+  Callback callback_;
+  size_t num_added_;
+  Stats stats_;
+  std::array<Buckets, 2> pending_;
+  //! Unpaired messages per input in arrival order (id -> stamp)
+  std::array<std::map<size_t, uint64_t>, 2> order_;
+};
+
+template <typename T>
+void StampJoin<T>::add(size_t input, uint64_t stamp_ns, const T& msg) {
+  const size_t other = 1 - input;
+  T match;
+  if (take(other, stamp_ns, match)) {
+    ++stats_.num_matched;
+    if (input == 0) {
+      callback_(msg, match);
+    } else {
+      callback_(match, msg);
+    }
+    return;
+  }
+
+  const size_t id = num_added_++;
+  pending_[input][bucket(stamp_ns)].push_back({stamp_ns, id, msg});
+  auto& order = order_[input];
+  order.emplace(id, stamp_ns);
+  while (order.size() > config.max_pending) {
+    const auto oldest = order.begin();
+    erase(input, oldest->second, oldest->first);
+    ++stats_.num_unmatched[input];
+  }
+}
+
+template <typename T>
+void StampJoin<T>::flush() {
+  for (size_t input = 0; input < 2; ++input) {
+    stats_.num_unmatched[input] += order_[input].size();
+    order_[input].clear();
+    pending_[input].clear();
+  }
+}
+
+template <typename T>
+bool StampJoin<T>::take(size_t input, uint64_t stamp_ns, T& msg) {
+  const Entry* best = nullptr;
+  uint64_t best_diff = 0;
+  const auto center = bucket(stamp_ns);
+  const auto first = config.tolerance_ns && center ? center - 1 : center;
+  const auto last = config.tolerance_ns ? center + 1 : center;
+  for (auto b = first; b <= last; ++b) {
+    const auto iter = pending_[input].find(b);
+    if (iter == pending_[input].end()) {
+      continue;
+    }
+
+    for (const auto& entry : iter->second) {
+      const auto diff = entry.stamp_ns > stamp_ns ? entry.stamp_ns - stamp_ns
+                                                  : stamp_ns - entry.stamp_ns;
+      // ties go to the earliest message
+      if (diff <= config.tolerance_ns &&
+          (!best || diff < best_diff || (diff == best_diff && entry.id < best->id))) {
+        best = &entry;
+        best_diff = diff;
+      }
+    }
+  }
+
+  if (!best) {
+    return false;
+  }
+
+  msg = best->msg;
+  erase(input, best->stamp_ns, best->id);
+  return true;
+}
+
+template <typename T>
+void StampJoin<T>::erase(size_t input, uint64_t stamp_ns, size_t id) {
+  order_[input].erase(id);
+  const auto iter = pending_[input].find(bucket(stamp_ns));
+  if (iter == pending_[input].end()) {
+    return;
+  }
+
+  auto& entries = iter->second;
+  for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+    if (entry->id == id) {
+      entries.erase(entry);
+      break;
+    }
+  }
+
+  if (entries.empty()) {
+    pending_[input].erase(iter);
+  }
+}
+
+}  // namespace hydra
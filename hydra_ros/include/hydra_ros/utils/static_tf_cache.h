@@ -0,0 +1,94 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <sensor_msgs/CameraInfo.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "hydra_ros/utils/pose_cache.h"
+
+namespace hydra {
+
+/**
+ * @brief Process-wide cache of static transforms (and camera info) used during startup
+ *
+ * Sensor extrinsics and intrinsics are loaded one sensor at a time. Without the cache,
+ * every sensor waits for /tf_static with a new listener or reopens the bag. The live
+ * buffer is filled by a single listener and each bag is read at most once.
+ */
+class StaticTfCache {
+ public:
+  struct BagContents {
+    explicit BagContents(const rosbag::Bag& bag);
+
+    //! Static transforms from the bag
+    PoseCache poses;
+    //! First camera info message for every camera info topic in the bag
+    std::map<std::string, sensor_msgs::CameraInfo::ConstPtr> camera_info;
+  };
+
+  static StaticTfCache& instance();
+
+  /**
+   * @brief Tf buffer shared by all live lookups (the listener starts on first use)
+   */
+  const tf2_ros::Buffer& liveBuffer();
+
+  /**
+   * @brief Get the (cached) static transforms and camera info from a bag
+   */
+  std::shared_ptr<const BagContents> loadBag(const std::filesystem::path& bag_path);
+
+  /**
+   * @brief Stop the live listener and drop all cached bags
+   */
+  void reset();
+
+ private:
+  StaticTfCache() = default;
+
+  std::mutex mutex_;
+  std::unique_ptr<tf2_ros::Buffer> buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> listener_;
+  std::map<std::string, std::shared_ptr<const BagContents>> bags_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,85 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/reconstruction/volumetric_map.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hydra {
+
+class WorkerPool;
+
+/**
+ * @brief Fuse one TSDF voxel into another
+ *
+ * Computes the weighted mean of both distances and colors, which is the same result as
+ * integrating the observations behind both voxels into a single voxel as long as the
+ * combined weight stays below max_weight (up to floating point rounding).
+ */
+inline void fuseTsdfVoxel(const TsdfVoxel& from,
+                          TsdfVoxel& into,
+                          float max_weight = std::numeric_limits<float>::max()) {
+  if (from.weight <= 0.0f) {
+    return;
+  }
+
+  const float total = into.weight + from.weight;
+  const float alpha = from.weight / total;
+  into.distance += alpha * (from.distance - into.distance);
+  const auto blend = [alpha](uint8_t lhs, uint8_t rhs) -> uint8_t {
+    return std::lround(lhs + alpha * (static_cast<float>(rhs) - lhs));
+  };
+  into.color.r = blend(into.color.r, from.color.r);
+  into.color.g = blend(into.color.g, from.color.g);
+  into.color.b = blend(into.color.b, from.color.b);
+  into.color.a = blend(into.color.a, from.color.a);
+  into.weight = std::min(total, max_weight);
+}
+
+/**
+ * @brief Fuse every observed voxel of one TSDF layer into another
+ *
+ * Blocks missing from the output layer are allocated serially and then fused in
+ * parallel (if a pool is provided). Both layers must have the same geometry.
+ * @returns Number of blocks that were fused
+ */
+size_t fuseTsdfLayers(const TsdfLayer& from,
+                      TsdfLayer& into,
+                      float max_weight = std::numeric_limits<float>::max(),
+                      WorkerPool* pool = nullptr);
+
+}  // namespace hydra
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# Copyright 2022, Massachusetts Institute of Technology.
+# All Rights Reserved
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#  1. Redistributions of source code must retain the above copyright notice,
+#     this list of conditions and the following disclaimer.
+#
+#  2. Redistributions in binary form must reproduce the above copyright notice,
+#     this list of conditions and the following disclaimer in the documentation
+#     and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Research was sponsored by the United States Air Force Research Laboratory and
+# the United States Air Force Artificial Intelligence Accelerator and was
+# accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+# and conclusions contained in this document are those of the authors and should
+# not be interpreted as representing the official policies, either expressed or
+"""Measure how long hydra takes to start with six live cameras.
+
+Runs launch/utils/startup_benchmark.launch several times and reports how long the
+node takes to advertise its shutdown service (i.e., to finish initializing). To
+compare two versions, build each one and run this script with the same arguments.
+The wall-clock time works for every version; "Loaded sensors in" is only logged by
+versions that time HydraRosPipeline::init.
+"""
+import argparse
+import re
+import statistics
+import subprocess
+import threading
+import time
+
+import rosgraph
+
+SERVICE = "/hydra_ros_node/shutdown"
+INIT_REGEX = re.compile(
+    r"Loaded sensors in ([0-9.e+-]+) \[s\], initialized pipeline in ([0-9.e+-]+) \[s\]"
+)
+
+
+def _have_service(master, name):
+    try:
+        master.lookupService(name)
+        return True
+    except rosgraph.MasterException:
+        return False
+
+
+def _read_output(proc, result):
+    for line in proc.stdout:
+        match = INIT_REGEX.search(line)
+        if match:
+            result["sensors"] = float(match.group(1))
+            result["init"] = float(match.group(2))
+
+
+def _run_once(launch_args, timeout_s):
+    master = rosgraph.Master("/hydra_startup_benchmark")
+    cmd = ["roslaunch", "hydra_ros", "startup_benchmark.launch"] + launch_args
+    result = {}
+    start = time.monotonic()
+    proc = subprocess.Popen(
+        cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True
+    )
+    reader = threading.Thread(target=_read_output, args=(proc, result), daemon=True)
+    reader.start()
+
+    while not _have_service(master, SERVICE):
+        if proc.poll() is not None:
+            raise RuntimeError(f"roslaunch exited with {proc.returncode}")
+
+        if time.monotonic() - start > timeout_s:
+            proc.terminate()
+            proc.wait()
+            raise RuntimeError(f"hydra did not start within {timeout_s} [s]")
+
+        time.sleep(0.01)
+
+    result["ready"] = time.monotonic() - start
+    subprocess.run(["rosservice", "call", SERVICE], check=False, capture_output=True)
+    try:
+        proc.wait(timeout=30.0)
+    except subprocess.TimeoutExpired:
+        proc.terminate()
+        proc.wait()
+
+    reader.join(timeout=1.0)
+    return result
+
+
+def _summarize(name, values):
+    if not values:
+        return
+
+    print(
+        f"{name}: mean {statistics.mean(values):.3f} [s], "
+        f"min {min(values):.3f} [s], max {max(values):.3f} [s]"
+    )
+
+
+def main():
+    """Run the benchmark."""
+    parser = argparse.ArgumentParser(description="time hydra startup with 6 cameras")
+    parser.add_argument("-n", "--runs", type=int, default=5, help="number of runs")
+    parser.add_argument(
+        "--info-rate", type=float, default=1.0, help="camera info rate [Hz]"
+    )
+    parser.add_argument(
+        "--timeout", type=float, default=120.0, help="time allowed per run [s]"
+    )
+    parser.add_argument(
+        "launch_args", nargs="*", help="extra arguments (name:=value) for roslaunch"
+    )
+    args = parser.parse_args()
+
+    # a fresh master per run would be included in the timing
+    roscore = None
+    if not rosgraph.is_master_online():
+        roscore = subprocess.Popen(
+            ["roscore"], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL
+        )
+        while not rosgraph.is_master_online():
+            time.sleep(0.1)
+
+    launch_args = [f"info_rate:={args.info_rate}"] + args.launch_args
+    results = []
+    try:
+        for i in range(args.runs):
+            result = _run_once(launch_args, args.timeout)
+            results.append(result)
+            line = f"run {i}: ready after {result['ready']:.3f} [s]"
+            if "sensors" in result:
+                line += f" (sensors: {result['sensors']:.3f} [s],"
+                line += f" init: {result['init']:.3f} [s])"
+
+            print(line, flush=True)
+    finally:
+        if roscore is not None:
+            roscore.terminate()
+            roscore.wait()
+
+    _summarize("ready", [x["ready"] for x in results])
+    _summarize("sensors", [x["sensors"] for x in results if "sensors" in x])
+    _summarize("init", [x["init"] for x in results if "init" in x])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,55 @@
+#!/bin/bash
+# Runs hydra_offline twice with the same config and checks that the saved scene graphs
+# are identical, e.g.,
+#
+#   ./check_offline_determinism.sh $(rospack find hydra_ros)/config/offline/uhumans2.yaml
+#
+# Use a short bag (or set 'duration' in the config) to keep the check quick.
+
+if [[ $# -eq 0 ]] ; then
+    echo 'Offline pipeline config required!!'
+    exit 1
+fi
+
+config=$(realpath "$1")
+output=$(mktemp -d /tmp/hydra_offline_check.XXXXXX)
+
+for run in first second ; do
+    # overrides the output directory of the provided config
+    cat > "$output/$run.yaml" << END
+include:
+  - {path: $config}
+log_path: $output/$run
+END
+
+    mkdir -p "$output/$run"
+    if ! rosrun hydra_ros hydra_offline --config="$output/$run.yaml" --minloglevel=1 ; then
+        echo "hydra_offline failed on the $run run (output in $output)"
+        exit 1
+    fi
+done
+
+num_compared=0
+status=0
+while IFS= read -r -d '' file ; do
+    relative=${file#"$output/first/"}
+    num_compared=$((num_compared + 1))
+    if ! cmp -s "$file" "$output/second/$relative" ; then
+        echo "Scene graphs differ: $relative"
+        status=1
+    fi
+done < <(find "$output/first" -type f -name 'dsg*' -print0)
+
+if [[ $num_compared -eq 0 ]] ; then
+    echo "No scene graphs saved in $output/first"
+    exit 1
+fi
+
+if [[ $status -eq 0 ]] ; then
+    echo "Compared $num_compared scene graph(s): identical"
+    rm -rf "$output"
+else
+    echo "Outputs kept in $output"
+fi
+
+exit $status
@@ -37,6 +37,8 @@
 #include <config_utilities/printing.h>
 #include <pose_graph_tools_ros/conversions.h>
 
+#include "hydra_ros/utils/node_utilities.h"
+
 namespace hydra {
 
 using kimera_pgmo::DeformationGraph;
@@ -48,7 +50,7 @@ RosBackend::RosBackend(const Config& config,
                        const SharedDsgInfo::Ptr& dsg,
                        const SharedModuleState::Ptr& state,
                        const LogSetup::Ptr& log_setup)
-    : BackendModule(config, dsg, state, log_setup), nh_("~") {
+    : BackendModule(config, dsg, state, log_setup), nh_(getNodeHandle("~")) {
   pose_graph_sub_ = nh_.subscribe(
       "pose_graph_incremental", 10000, &RosBackend::poseGraphCallback, this);
 
@@ -39,6 +39,8 @@
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
 
+#include "hydra_ros/utils/node_utilities.h"
+
 namespace hydra {
 
 using visualization_msgs::Marker;
@@ -55,7 +57,7 @@ void declare_config(ObjectVisualizer::Config& config) {
 }
 
 ObjectVisualizer::ObjectVisualizer(const Config& config)
-    : config(config::checkValid(config)), nh_(config.module_ns) {
+    : config(config::checkValid(config)), nh_(getNodeHandle(config.module_ns)) {
   if (config.enable_active_mesh_pub) {
     active_vertices_pub_ = nh_.advertise<Marker>("active_vertices", 1, true);
   }
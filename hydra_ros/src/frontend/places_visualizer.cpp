@@ -42,6 +42,7 @@
 #include <hydra/places/compression_graph_extractor.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include "hydra_ros/utils/node_utilities.h"
 #include "hydra_ros/visualizer/gvd_visualization_utilities.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
 
@@ -68,7 +69,7 @@ void declare_config(PlacesVisualizer::Config& config) {
 
 PlacesVisualizer::PlacesVisualizer(const Config& config)
     : config_(config),
-      nh_(config.ns),
+      nh_(getNodeHandle(config.ns)),
       previous_spheres_(0),
       published_gvd_graph_(false) {
   pubs_.reset(new MarkerGroupPub(nh_));
@@ -0,0 +1,394 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/hydra_bag_pipeline.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/yaml.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <hydra/backend/backend_module.h>
+#include <hydra/common/global_info.h>
+#include <hydra/frontend/frontend_module.h>
+#include <hydra/loop_closure/loop_closure_module.h>
+#include <hydra/reconstruction/reconstruction_module.h>
+#include <pose_graph_tools_ros/conversions.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "hydra_ros/hydra_ros_pipeline.h"
+#include "hydra_ros/odometry/bag_pose_graph_tracker.h"
+
+namespace hydra {
+
+void declare_config(HydraBagConfig& config) {
+  using namespace config;
+  name("HydraBagConfig");
+  field(config.bags, "bags");
+  field(config.start, "start");
+  field(config.duration, "duration");
+  field(config.lockstep, "lockstep");
+  field(config.max_pending, "max_pending");
+  field(config.pose_graph_topic, "pose_graph_topic");
+  field(config.prior_topic, "prior_topic");
+  field(config.poll_period_s, "poll_period_s");
+  field(config.input, "input");
+  checkCondition(!config.bags.empty(), "bags required");
+  check(config.max_pending, GT, 0, "max_pending");
+  check(config.poll_period_s, GT, 0.0, "poll_period_s");
+}
+
+namespace {
+
+void mergeYaml(YAML::Node& target, const YAML::Node& source) {
+  if (!source || source.IsNull()) {
+    return;
+  }
+
+  if (!target.IsMap() || !source.IsMap()) {
+    target = YAML::Clone(source);
+    return;
+  }
+
+  for (const auto& entry : source) {
+    const auto key = entry.first.as<std::string>();
+    if (!target[key]) {
+      target[key] = YAML::Clone(entry.second);
+      continue;
+    }
+
+    YAML::Node child = target[key];
+    mergeYaml(child, entry.second);
+  }
+}
+
+}  // namespace
+
+YAML::Node loadBagPipelineConfig(const std::filesystem::path& path) {
+  const auto contents = YAML::LoadFile(path.string());
+  const auto includes = contents["include"];
+  YAML::Node config(YAML::NodeType::Map);
+  if (includes) {
+    CHECK(includes.IsSequence()) << "'include' must be a list in " << path;
+    for (const auto& entry : includes) {
+      CHECK(entry["path"]) << "included file requires 'path' in " << path;
+      const auto ns = entry["ns"].as<std::string>("");
+      std::filesystem::path include_path = entry["path"].as<std::string>();
+      if (include_path.is_relative()) {
+        include_path = path.parent_path() / include_path;
+      }
+
+      VLOG(1) << "Including " << include_path << " under '" << ns << "'";
+      auto included = loadBagPipelineConfig(include_path);
+      if (ns.empty()) {
+        mergeYaml(config, included);
+      } else {
+        YAML::Node child = config[ns];
+        mergeYaml(child, included);
+      }
+    }
+  }
+
+  for (const auto& entry : contents) {
+    const auto key = entry.first.as<std::string>();
+    if (key == "include") {
+      continue;
+    }
+
+    YAML::Node child = config[key];
+    mergeYaml(child, entry.second);
+  }
+
+  return config;
+}
+
+HydraBagPipeline::HydraBagPipeline(const YAML::Node& config, int robot_id)
+    : HydraPipeline(config::fromYaml<PipelineConfig>(config), robot_id),
+      node_(config),
+      config_(config::checkValid(config::fromYaml<HydraBagConfig>(config))),
+      bag_input_(nullptr),
+      num_packets_(0),
+      num_rejected_(0),
+      num_dropped_(0) {}
+
+HydraBagPipeline::~HydraBagPipeline() {}
+
+void HydraBagPipeline::init() {
+  const auto& pipeline_config = GlobalInfo::instance().getConfig();
+  initFrontend();
+  initBackend();
+  initReconstruction();
+  if (pipeline_config.enable_lcd) {
+    initLCD();
+  }
+
+  const auto reconstruction = getModule<ReconstructionModule>("reconstruction");
+  CHECK(reconstruction);
+  reconstruction_queue_ = reconstruction->queue();
+  // in lockstep the driver forwards each packet to reconstruction itself
+  input_queue_ = config_.lockstep ? std::make_shared<BagInputModule::OutputQueue>()
+                                  : reconstruction_queue_;
+  bag_input_ = new BagInputModule(config_.input, input_queue_);
+  input_module_.reset(bag_input_);
+  receivers_ = bag_input_->receivers();
+  BagPoseGraphTracker::reset();
+}
+
+void HydraBagPipeline::initFrontend() {
+  const auto logs = GlobalInfo::instance().getLogs();
+  FrontendModule::Ptr frontend = config::createFromYaml<FrontendModule>(
+      node_["frontend"], frontend_dsg_, shared_state_, logs);
+  CHECK(frontend) << "Frontend module required!";
+  modules_["frontend"] = frontend;
+}
+
+void HydraBagPipeline::initBackend() {
+  const auto logs = GlobalInfo::instance().getLogs();
+  BackendModule::Ptr backend = config::createFromYaml<BackendModule>(
+      node_["backend"], frontend_dsg_, backend_dsg_, shared_state_, logs);
+  CHECK(backend) << "Failed to construct backend!";
+  modules_["backend"] = backend;
+
+  const auto frontend = getModule<FrontendModule>("frontend");
+  if (frontend) {
+    addBackendUpdateFunctors(*backend, *frontend);
+  }
+}
+
+void HydraBagPipeline::initReconstruction() {
+  const auto frontend = getModule<FrontendModule>("frontend");
+  CHECK(frontend);
+  modules_["reconstruction"] = config::createFromYaml<ReconstructionModule>(
+      node_["reconstruction"], frontend->getQueue());
+}
+
+void HydraBagPipeline::initLCD() {
+  auto lcd_config = config::fromYaml<LoopClosureConfig>(node_);
+  lcd_config.detector.num_semantic_classes = GlobalInfo::instance().getTotalLabels();
+  config::checkValid(lcd_config);
+
+  // NOTE: bag-of-words descriptors are only available from the online pipeline
+  shared_state_->lcd_queue.reset(new InputQueue<LcdInput::Ptr>());
+  modules_["lcd"] = std::make_shared<LoopClosureModule>(lcd_config, shared_state_);
+}
+
+void HydraBagPipeline::run() {
+  CHECK(bag_input_) << "init() must be called before run()";
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& bag_path : config_.bags) {
+    readBag(bag_path);
+  }
+
+  waitUntilIdle();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "Processed " << num_packets_ << " packets in " << elapsed.count()
+            << " [s] (" << num_rejected_ << " rejected, " << num_dropped_
+            << " without pose)";
+}
+
+void HydraBagPipeline::readBag(const std::string& bag_path) {
+  LOG(INFO) << "Reading " << bag_path;
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+
+  // the input module is idle between bags, so swapping poses is safe
+  waitUntilIdle();
+  bag_input_->setPoses(std::make_shared<PoseCache>(bag));
+
+  std::vector<std::string> topics;
+  for (const auto receiver : receivers_) {
+    const auto receiver_topics = receiver->topics();
+    topics.insert(topics.end(), receiver_topics.begin(), receiver_topics.end());
+  }
+
+  for (const auto& topic : {config_.pose_graph_topic, config_.prior_topic}) {
+    if (!topic.empty()) {
+      topics.push_back(topic);
+    }
+  }
+
+  ros::Time start;
+  bool have_start = false;
+  rosbag::View view(bag, rosbag::TopicQuery(topics));
+  for (const auto& m : view) {
+    if (!have_start) {
+      start = m.getTime();
+      if (config_.start >= 0.0) {
+        start += ros::Duration(config_.start);
+      }
+      have_start = true;
+    }
+
+    const auto diff_s = (m.getTime() - start).toSec();
+    if (diff_s < 0.0) {
+      continue;
+    }
+
+    if (config_.duration >= 0.0 && diff_s > config_.duration) {
+      LOG(INFO) << "Reached end of duration: " << diff_s << " [s]";
+      break;
+    }
+
+    const auto& topic = m.getTopic();
+    if (topic == config_.pose_graph_topic || topic == config_.prior_topic) {
+      handlePoseGraph(m);
+      continue;
+    }
+
+    for (const auto receiver : receivers_) {
+      auto packet = receiver->convert(m);
+      if (packet) {
+        pushPacket(*receiver, std::move(packet));
+      }
+    }
+  }
+
+  waitUntilIdle();
+  bag.close();
+
+  for (const auto receiver : receivers_) {
+    // images are never paired across bags
+    receiver->flush();
+    LOG_IF(WARNING, receiver->numUnmatched() > 0)
+        << "Dropped " << receiver->numUnmatched() << " unmatched image(s) for '"
+        << receiver->config.depth_topic << "'";
+  }
+}
+
+void HydraBagPipeline::handlePoseGraph(const rosbag::MessageInstance& m) {
+  const auto msg = m.instantiate<pose_graph_tools_msgs::PoseGraph>();
+  if (!msg) {
+    LOG(ERROR) << "Unable to parse pose graph from '" << m.getTopic() << "'";
+    return;
+  }
+
+  auto graph =
+      std::make_shared<pose_graph_tools::PoseGraph>(pose_graph_tools::fromMsg(*msg));
+  if (m.getTopic() == config_.prior_topic) {
+    BagPoseGraphTracker::setExternalPriors(graph);
+    return;
+  }
+
+  if (msg->nodes.empty()) {
+    LOG(WARNING) << "Skipping empty pose graph @ " << msg->header.stamp.toNSec()
+                 << " [ns]";
+    return;
+  }
+
+  BagPoseGraphTracker::addPoseGraph(graph);
+}
+
+void HydraBagPipeline::pushPacket(BagDataReceiver& receiver,
+                                  InputPacket::Ptr&& packet) {
+  // only the receiver queue and then the input module own the packet from here on
+  const std::weak_ptr<InputPacket> pending = packet;
+  const bool accepted = receiver.push(packet);
+  packet.reset();
+  if (!accepted) {
+    ++num_rejected_;
+    return;
+  }
+
+  ++num_packets_;
+  if (!config_.lockstep) {
+    while (numPending() > config_.max_pending) {
+      sleep();
+    }
+
+    return;
+  }
+
+  // the input module either forwards the packet to its output queue or drops it
+  // (for any reason), which releases the last reference to it
+  while (!input_queue_->size()) {
+    if (pending.expired()) {
+      ++num_dropped_;
+      return;
+    }
+
+    sleep();
+  }
+
+  reconstruction_queue_->push(input_queue_->front());
+  input_queue_->pop();
+  waitUntilIdle();
+}
+
+size_t HydraBagPipeline::numPending() const {
+  size_t pending = input_queue_->size();
+  if (input_queue_ != reconstruction_queue_) {
+    pending += reconstruction_queue_->size();
+  }
+
+  for (const auto receiver : receivers_) {
+    pending += receiver->queue.size();
+  }
+
+  return pending;
+}
+
+bool HydraBagPipeline::idle() const {
+  if (numPending() > 0) {
+    return false;
+  }
+
+  // modules only pop their inputs once they are done with them
+  const auto frontend = getModule<FrontendModule>("frontend");
+  if (frontend && frontend->getQueue()->size()) {
+    return false;
+  }
+
+  if (shared_state_->backend_queue && shared_state_->backend_queue->size()) {
+    return false;
+  }
+
+  return !shared_state_->lcd_queue || !shared_state_->lcd_queue->size();
+}
+
+void HydraBagPipeline::waitUntilIdle() const {
+  while (!idle()) {
+    sleep();
+  }
+}
+
+void HydraBagPipeline::sleep() const {
+  std::this_thread::sleep_for(std::chrono::duration<double>(config_.poll_period_s));
+}
+
+}  // namespace hydra
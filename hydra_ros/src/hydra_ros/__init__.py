@@ -6,6 +6,34 @@ import spark_dsg as dsg
 import hydra_msgs.msg
 import std_msgs.msg
 
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+try:
+    import lz4.block
+except ImportError:
+    lz4 = None
+
+
+def _decompress(msg):
+    """Get the uncompressed graph payload of an update."""
+    if msg.codec == hydra_msgs.msg.DsgUpdate.CODEC_NONE:
+        return msg.layer_contents
+
+    if msg.codec == hydra_msgs.msg.DsgUpdate.CODEC_ZSTD and zstandard is not None:
+        return zstandard.ZstdDecompressor().decompress(
+            msg.layer_contents, max_output_size=msg.uncompressed_size
+        )
+
+    if msg.codec == hydra_msgs.msg.DsgUpdate.CODEC_LZ4 and lz4 is not None:
+        return lz4.block.decompress(
+            msg.layer_contents, uncompressed_size=msg.uncompressed_size
+        )
+
+    raise RuntimeError(f"Unsupported dsg codec {msg.codec}")
+
 
 class DsgPublisher:
     """Class for publishing a scene graph from python."""
@@ -28,6 +56,8 @@ class DsgPublisher:
             msg = hydra_msgs.msg.DsgUpdate()
             msg.header = header
             msg.layer_contents = G.to_binary(self._publish_mesh)
+            msg.codec = hydra_msgs.msg.DsgUpdate.CODEC_NONE
+            msg.uncompressed_size = len(msg.layer_contents)
             msg.full_update = True
             self._pub.publish(msg)
 
@@ -46,16 +76,21 @@ class DsgSubscriber:
         )
 
     def _handle_update(self, msg):
-        if not msg.full_update:
-            raise NotImplementedError("Partial updates not implemented yet")
-
         size_bytes = len(msg.layer_contents)
         rospy.logdebug(f"Received dsg update message of {size_bytes} bytes")
 
+        # deltas are not applied in python: the graph only changes on keyframes
+        if not msg.full_update:
+            rospy.logwarn_once(
+                "Skipping dsg deltas: set 'dsg_keyframe_period' to 0 on the sender"
+            )
+            return
+
+        contents = _decompress(msg)
         if not self._graph_set:
-            self._graph = dsg.DynamicSceneGraph.from_binary(msg.layer_contents)
+            self._graph = dsg.DynamicSceneGraph.from_binary(contents)
             self._graph_set = True
         else:
-            self._graph.update_from_binary(msg.layer_contents)
+            self._graph.update_from_binary(contents)
 
         self._callback(msg.header, self._graph)
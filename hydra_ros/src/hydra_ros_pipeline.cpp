@@ -48,12 +48,15 @@
 #include <hydra/reconstruction/reconstruction_module.h>
 #include <pose_graph_tools_ros/conversions.h>
 
+#include <chrono>
 #include <memory>
 
 #include "hydra_ros/backend/ros_backend_publisher.h"
 #include "hydra_ros/frontend/ros_frontend_publisher.h"
 #include "hydra_ros/loop_closure/ros_lcd_registration.h"
 #include "hydra_ros/utils/bow_subscriber.h"
+#include "hydra_ros/utils/camera_info_prefetcher.h"
+#include "hydra_ros/utils/static_tf_cache.h"
 
 namespace hydra {
 
@@ -64,6 +67,21 @@ void declare_config(HydraRosConfig& conf) {
   field(conf.input, "input");
 }
 
+void addBackendUpdateFunctors(BackendModule& backend, const FrontendModule& frontend) {
+  if (frontend.config.surface_places) {
+    // LOG(INFO) << "Setting up surface places update";
+    auto places_functor =
+        std::make_shared<Update2dPlacesFunctor>(backend.config.places2d_config);
+    backend.setUpdateFunctor(DsgLayers::MESH_PLACES, places_functor);
+  }
+
+  if (frontend.config.use_frontiers && frontend.config.frontier_places) {
+    auto frontiers_functor =
+        std::make_shared<UpdateFrontiersFunctor>(backend.config.frontier_config);
+    backend.setUpdateFunctor(DsgLayers::BUILDINGS + 1, frontiers_functor);
+  }
+}
+
 HydraRosPipeline::HydraRosPipeline(const ros::NodeHandle& nh, int robot_id)
     : HydraPipeline(config::fromRos<PipelineConfig>(nh), robot_id),
       config_(config::checkValid(config::fromRos<HydraRosConfig>(nh))),
@@ -72,6 +90,7 @@ HydraRosPipeline::HydraRosPipeline(const ros::NodeHandle& nh, int robot_id)
 HydraRosPipeline::~HydraRosPipeline() {}
 
 void HydraRosPipeline::init() {
+  const auto start = std::chrono::steady_clock::now();
   const auto& pipeline_config = GlobalInfo::instance().getConfig();
   initFrontend();
   initBackend();
@@ -83,7 +102,18 @@ void HydraRosPipeline::init() {
 
   const auto reconstruction = getModule<ReconstructionModule>("reconstruction");
   CHECK(reconstruction);
+  const auto input_start = std::chrono::steady_clock::now();
   input_module_.reset(new RosInputModule(config_.input, reconstruction->queue()));
+  // every sensor has been loaded at this point
+  CameraInfoPrefetcher::instance().reset();
+  StaticTfCache::instance().reset();
+
+  // parsed by scripts/benchmark_startup.py
+  const auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> input_elapsed = end - input_start;
+  const std::chrono::duration<double> elapsed = end - start;
+  LOG(INFO) << "Loaded sensors in " << input_elapsed.count()
+            << " [s], initialized pipeline in " << elapsed.count() << " [s]";
 }
 
 void HydraRosPipeline::initFrontend() {
@@ -114,18 +144,7 @@ void HydraRosPipeline::initBackend() {
     return;
   }
 
-  if (frontend->config.surface_places) {
-    // LOG(INFO) << "Setting up surface places update";
-    auto places_functor =
-        std::make_shared<Update2dPlacesFunctor>(backend->config.places2d_config);
-    backend->setUpdateFunctor(DsgLayers::MESH_PLACES, places_functor);
-  }
-
-  if (frontend->config.use_frontiers && frontend->config.frontier_places) {
-    auto frontiers_functor =
-        std::make_shared<UpdateFrontiersFunctor>(backend->config.frontier_config);
-    backend->setUpdateFunctor(DsgLayers::BUILDINGS + 1, frontiers_functor);
-  }
+  addBackendUpdateFunctors(*backend, *frontend);
 }
 
 void HydraRosPipeline::initReconstruction() {
@@ -0,0 +1,146 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/backpressure_policy.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <optional>
+
+namespace hydra {
+
+using Mode = BackpressurePolicy::Mode;
+
+namespace {
+
+inline std::optional<Mode> parseMode(const std::string& mode) {
+  if (mode == "none") {
+    return Mode::NONE;
+  }
+
+  if (mode == "keep_latest") {
+    return Mode::KEEP_LATEST;
+  }
+
+  if (mode == "keep_every_nth") {
+    return Mode::KEEP_EVERY_NTH;
+  }
+
+  if (mode == "drop") {
+    return Mode::DROP;
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& out, Mode mode) {
+  switch (mode) {
+    case Mode::NONE:
+      out << "none";
+      break;
+    case Mode::KEEP_LATEST:
+      out << "keep_latest";
+      break;
+    case Mode::KEEP_EVERY_NTH:
+      out << "keep_every_nth";
+      break;
+    case Mode::DROP:
+      out << "drop";
+      break;
+  }
+
+  return out;
+}
+
+void declare_config(BackpressurePolicy::Config& config) {
+  using namespace config;
+  name("BackpressurePolicy::Config");
+  field(config.mode, "mode");
+  field(config.max_queue_depth, "max_queue_depth");
+  field(config.keep_every_n, "keep_every_n");
+  checkCondition(parseMode(config.mode).has_value(),
+                 "mode must be one of none, keep_latest, keep_every_nth or drop");
+  checkCondition(config.keep_every_n > 0, "keep_every_n must be positive");
+}
+
+BackpressurePolicy::BackpressurePolicy(const Config& config)
+    : config(config::checkValid(config)),
+      mode_(parseMode(this->config.mode).value_or(Mode::NONE)),
+      num_received_(0),
+      num_dropped_(0),
+      num_since_kept_(0) {}
+
+BackpressurePolicy::Decision BackpressurePolicy::update(size_t receiver_depth,
+                                                        size_t downstream_depth) {
+  ++num_received_;
+  Decision decision;
+  const size_t depth = receiver_depth + downstream_depth;
+  if (mode_ == Mode::NONE || depth <= config.max_queue_depth) {
+    num_since_kept_ = 0;
+    return decision;
+  }
+
+  switch (mode_) {
+    case Mode::KEEP_LATEST:
+      decision.clear_queue = receiver_depth > 0;
+      num_dropped_ += receiver_depth;
+      break;
+    case Mode::KEEP_EVERY_NTH:
+      decision.keep = num_since_kept_ + 1 >= config.keep_every_n;
+      num_since_kept_ = decision.keep ? 0 : num_since_kept_ + 1;
+      break;
+    case Mode::DROP:
+      decision.keep = false;
+      break;
+    case Mode::NONE:
+    default:
+      break;
+  }
+
+  if (!decision.keep) {
+    ++num_dropped_;
+  }
+
+  VLOG(2) << "[BackpressurePolicy] " << mode_ << ": queue depth " << depth << " > "
+          << config.max_queue_depth
+          << ", keep: " << std::boolalpha << decision.keep
+          << ", clear: " << decision.clear_queue;
+  return decision;
+}
+
+}  // namespace hydra
@@ -0,0 +1,283 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/bag_input_module.h"
+
+#include <config_utilities/config.h>
+#include <glog/logging.h>
+#include <hydra/common/global_info.h>
+#include <rosbag/message_instance.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include "hydra_ros/input/pointcloud_adaptor.h"
+#include "hydra_ros/utils/compressed_image.h"
+#include "hydra_ros/utils/shared_image.h"
+
+namespace hydra {
+
+void declare_config(BagDataReceiver::Config& config) {
+  using namespace config;
+  name("BagDataReceiver::Config");
+  base<DataReceiver::Config>(config);
+  field(config.color_topic, "color_topic");
+  field(config.depth_topic, "depth_topic");
+  field(config.label_topic, "label_topic");
+  field(config.cloud_topic, "cloud_topic");
+  field(config.decimation, "decimation");
+  field(config.stamp_join, "stamp_join");
+  checkCondition(!config.depth_topic.empty() || !config.cloud_topic.empty(),
+                 "depth_topic or cloud_topic required");
+}
+
+namespace {
+
+// instantiates the message once for both the stamp and the image
+cv::Mat readImage(const rosbag::MessageInstance& msg,
+                  bool is_color,
+                  uint64_t& timestamp_ns) {
+  const auto raw = msg.instantiate<sensor_msgs::Image>();
+  if (raw) {
+    timestamp_ns = raw->header.stamp.toNSec();
+    try {
+      return viewImage(raw, is_color ? sensor_msgs::image_encodings::RGB8 : "").image;
+    } catch (const cv_bridge::Exception& e) {
+      LOG(ERROR) << "Unable to read image from '" << msg.getTopic()
+                 << "': " << e.what();
+      return cv::Mat();
+    }
+  }
+
+  const auto compressed = msg.instantiate<sensor_msgs::CompressedImage>();
+  if (compressed) {
+    timestamp_ns = compressed->header.stamp.toNSec();
+    return decodeCompressedImage(*compressed, is_color);
+  }
+
+  LOG(ERROR) << "Unable to parse image from '" << msg.getTopic() << "'";
+  return cv::Mat();
+}
+
+}  // namespace
+
+BagDataReceiver::BagDataReceiver(const Config& config, size_t sensor_id)
+    : DataReceiver(config, sensor_id),
+      config(config::checkValid(config)),
+      decimator_(config.decimation) {
+  if (!config.color_topic.empty() && !config.depth_topic.empty()) {
+    color_join_ = std::make_unique<StampJoin<Frame>>(
+        config.stamp_join, [this](const Frame& color, const Frame& depth) {
+          auto frame = depth;
+          frame.color = color.color;
+          addDepthFrame(frame);
+        });
+  }
+
+  if (!config.label_topic.empty() && !config.depth_topic.empty()) {
+    label_join_ = std::make_unique<StampJoin<Frame>>(
+        config.stamp_join, [this](const Frame& images, const Frame& labels) {
+          auto frame = images;
+          frame.labels = labels.labels;
+          emit(frame);
+        });
+  }
+}
+
+std::vector<std::string> BagDataReceiver::topics() const {
+  std::vector<std::string> topics;
+  for (const auto topic : {&config.color_topic,
+                           &config.depth_topic,
+                           &config.label_topic,
+                           &config.cloud_topic}) {
+    if (!topic->empty()) {
+      topics.push_back(*topic);
+    }
+  }
+
+  return topics;
+}
+
+InputPacket::Ptr BagDataReceiver::convert(const rosbag::MessageInstance& msg) {
+  const auto& topic = msg.getTopic();
+  if (topic == config.cloud_topic) {
+    return convertCloud(msg);
+  }
+
+  const bool is_color = topic == config.color_topic;
+  const bool is_depth = topic == config.depth_topic;
+  const bool is_labels = topic == config.label_topic;
+  if (!is_color && !is_depth && !is_labels) {
+    return nullptr;
+  }
+
+  Frame frame;
+  auto image = readImage(msg, is_color, frame.timestamp_ns);
+  if (image.empty()) {
+    return nullptr;
+  }
+
+  // joins call back synchronously, so at most one packet is completed per image
+  ready_.reset();
+  if (is_color) {
+    frame.color = image;
+    if (color_join_) {
+      color_join_->add(0, frame.timestamp_ns, frame);
+    }
+  } else if (is_depth) {
+    frame.depth = image;
+    if (color_join_) {
+      color_join_->add(1, frame.timestamp_ns, frame);
+    } else {
+      addDepthFrame(frame);
+    }
+  } else {
+    frame.labels = image;
+    if (label_join_) {
+      label_join_->add(1, frame.timestamp_ns, frame);
+    }
+  }
+
+  return std::move(ready_);
+}
+
+bool BagDataReceiver::push(const InputPacket::Ptr& packet) {
+  if (!packet || !checkInputTimestamp(packet->timestamp_ns)) {
+    return false;
+  }
+
+  queue.push(packet);
+  return true;
+}
+
+InputPacket::Ptr BagDataReceiver::convertCloud(
+    const rosbag::MessageInstance& msg) const {
+  const auto cloud = msg.instantiate<sensor_msgs::PointCloud2>();
+  if (!cloud) {
+    LOG(ERROR) << "Unable to parse pointcloud from '" << msg.getTopic() << "'";
+    return nullptr;
+  }
+
+  const auto timestamp_ns = cloud->header.stamp.toNSec();
+  auto packet = std::make_shared<CloudInputPacket>(timestamp_ns, sensor_id_);
+  if (!fillPointcloudPacket(*cloud, *packet, false)) {
+    LOG(ERROR) << "Unable to decode pointcloud @ " << timestamp_ns << " [ns]";
+    return nullptr;
+  }
+
+  packet->in_world_frame =
+      cloud->header.frame_id == GlobalInfo::instance().getFrames().odom;
+  return packet;
+}
+
+void BagDataReceiver::flush() {
+  for (auto join : {color_join_.get(), label_join_.get()}) {
+    if (join) {
+      join->flush();
+    }
+  }
+}
+
+size_t BagDataReceiver::numUnmatched() const {
+  size_t num_unmatched = 0;
+  for (auto join : {color_join_.get(), label_join_.get()}) {
+    if (join) {
+      const auto& stats = join->stats();
+      num_unmatched += stats.num_unmatched[0] + stats.num_unmatched[1];
+    }
+  }
+
+  return num_unmatched;
+}
+
+void BagDataReceiver::addDepthFrame(const Frame& frame) {
+  if (label_join_) {
+    label_join_->add(0, frame.timestamp_ns, frame);
+  } else {
+    emit(frame);
+  }
+}
+
+void BagDataReceiver::emit(const Frame& frame) {
+  auto packet = std::make_shared<ImageInputPacket>(frame.timestamp_ns, sensor_id_);
+  packet->color = decimator_.nearest(frame.color);
+  packet->depth = decimator_.depth(frame.depth);
+  packet->labels = decimator_.nearest(frame.labels);
+  ready_ = packet;
+}
+
+BagInputModule::BagInputModule(const Config& config, const OutputQueue::Ptr& queue)
+    : InputModule(config, queue) {}
+
+void BagInputModule::setPoses(const std::shared_ptr<const PoseCache>& poses) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  poses_ = poses;
+}
+
+std::vector<BagDataReceiver*> BagInputModule::receivers() const {
+  std::vector<BagDataReceiver*> receivers;
+  for (const auto& receiver : receivers_) {
+    auto bag_receiver = dynamic_cast<BagDataReceiver*>(receiver.get());
+    if (!bag_receiver) {
+      LOG(WARNING) << "Ignoring input that does not read from a bag";
+      continue;
+    }
+
+    receivers.push_back(bag_receiver);
+  }
+
+  return receivers;
+}
+
+PoseStatus BagInputModule::getBodyPose(uint64_t timestamp_ns) {
+  std::shared_ptr<const PoseCache> poses;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    poses = poses_;
+  }
+
+  PoseStatus status{false, {}, {}};
+  if (poses) {
+    const auto& frames = GlobalInfo::instance().getFrames();
+    const auto pose = poses->lookupPose(timestamp_ns, frames.odom, frames.robot);
+    status.is_valid = pose.valid;
+    status.target_p_source = pose.to_p_from;
+    status.target_R_source = pose.to_R_from;
+  }
+
+  return status;
+}
+
+}  // namespace hydra
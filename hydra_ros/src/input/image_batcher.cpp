@@ -0,0 +1,259 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/image_batcher.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+
+namespace hydra {
+
+namespace {
+
+// packet stamps of the most recent batches across all groups
+struct BatchIndex {
+  static constexpr size_t kMaxPackets = 1024;
+
+  static BatchIndex& instance() {
+    static BatchIndex index;
+    return index;
+  }
+
+  uint64_t add(const std::vector<uint64_t>& stamps) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto id = next_id++;
+    for (const auto stamp : stamps) {
+      batch_of[stamp] = id;
+      order.emplace_back(stamp, id);
+    }
+
+    while (order.size() > kMaxPackets) {
+      const auto& [stamp, old_id] = order.front();
+      // a newer batch may have reused the stamp
+      const auto iter = batch_of.find(stamp);
+      if (iter != batch_of.end() && iter->second == old_id) {
+        batch_of.erase(iter);
+      }
+      order.pop_front();
+    }
+
+    return id;
+  }
+
+  std::optional<uint64_t> find(uint64_t stamp) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto iter = batch_of.find(stamp);
+    if (iter == batch_of.end()) {
+      return std::nullopt;
+    }
+
+    return iter->second;
+  }
+
+  mutable std::mutex mutex;
+  uint64_t next_id = 0;
+  std::map<uint64_t, uint64_t> batch_of;
+  std::deque<std::pair<uint64_t, uint64_t>> order;
+};
+
+}  // namespace
+
+ImageBatcher::ImageBatcher(double window_s)
+    : window_ns(static_cast<uint64_t>(std::max(window_s, 0.0) * 1.0e9)),
+      num_filled_(0),
+      reference_ns_(0),
+      num_batches_(0),
+      num_skipped_(0),
+      num_dropped_(0) {}
+
+ImageBatcher::Ptr ImageBatcher::getGroup(const std::string& group, double window_s) {
+  static std::mutex registry_mutex;
+  static std::map<std::string, std::weak_ptr<ImageBatcher>> registry;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto batcher = registry[group].lock();
+  if (!batcher) {
+    batcher = std::make_shared<ImageBatcher>(window_s);
+    registry[group] = batcher;
+  }
+
+  const auto requested_ns = static_cast<uint64_t>(std::max(window_s, 0.0) * 1.0e9);
+  LOG_IF(WARNING, requested_ns != batcher->window_ns)
+      << "[ImageBatcher] group '" << group << "' already uses a window of "
+      << batcher->window_ns * 1.0e-9 << " [s] (requested " << window_s << " [s])";
+  return batcher;
+}
+
+std::optional<uint64_t> ImageBatcher::findBatch(uint64_t timestamp_ns) {
+  return BatchIndex::instance().find(timestamp_ns);
+}
+
+size_t ImageBatcher::addCamera(const Sink& sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sinks_.push_back(sink);
+  current_.push_back(nullptr);
+  return sinks_.size() - 1;
+}
+
+void ImageBatcher::removeCamera(size_t slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK_LT(slot, sinks_.size());
+  sinks_[slot] = nullptr;
+  if (current_[slot]) {
+    current_[slot].reset();
+    --num_filled_;
+  }
+}
+
+void ImageBatcher::submit(size_t slot, const InputPacket::Ptr& packet) {
+  if (!packet) {
+    return;
+  }
+
+  Batch ready;
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK_LT(slot, current_.size());
+    if (!sinks_[slot]) {
+      return;
+    }
+
+    const auto stamp = packet->timestamp_ns;
+    if (num_filled_ > 0) {
+      if (stamp + window_ns < reference_ns_) {
+        VLOG(2) << "[ImageBatcher] dropping late packet @ " << stamp
+                << " [ns] for camera " << slot << " (batch @ " << reference_ns_
+                << " [ns])";
+        ++num_dropped_;
+        return;
+      }
+
+      if (stamp > reference_ns_ + window_ns || current_[slot]) {
+        ready = takeBatch();
+      }
+    }
+
+    if (num_filled_ == 0) {
+      reference_ns_ = stamp;
+    }
+
+    current_[slot] = packet;
+    ++num_filled_;
+    if (num_filled_ == numActive()) {
+      auto complete = takeBatch();
+      ready.insert(ready.end(), complete.begin(), complete.end());
+    }
+  }
+
+  // cameras are emitted back-to-back so reconstruction integrates them together
+  for (const auto& [sink, to_push] : ready) {
+    sink(to_push);
+  }
+}
+
+void ImageBatcher::flush() {
+  Batch ready;
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready = takeBatch();
+  }
+
+  for (const auto& [sink, to_push] : ready) {
+    sink(to_push);
+  }
+}
+
+size_t ImageBatcher::numCameras() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numActive();
+}
+
+size_t ImageBatcher::numBatches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_batches_;
+}
+
+size_t ImageBatcher::numSkipped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_skipped_;
+}
+
+size_t ImageBatcher::numDropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_dropped_;
+}
+
+size_t ImageBatcher::numActive() const {
+  return std::count_if(
+      sinks_.begin(), sinks_.end(), [](const auto& sink) { return sink != nullptr; });
+}
+
+ImageBatcher::Batch ImageBatcher::takeBatch() {
+  Batch batch;
+  if (num_filled_ == 0) {
+    return batch;
+  }
+
+  for (size_t i = 0; i < current_.size(); ++i) {
+    if (!sinks_[i]) {
+      continue;
+    }
+
+    if (!current_[i]) {
+      VLOG(2) << "[ImageBatcher] camera " << i << " missed batch @ " << reference_ns_
+              << " [ns]";
+      ++num_skipped_;
+      continue;
+    }
+
+    batch.emplace_back(sinks_[i], current_[i]);
+    current_[i].reset();
+  }
+
+  // registered before the packets are forwarded so the pose lookup can find them
+  std::vector<uint64_t> stamps;
+  for (const auto& entry : batch) {
+    stamps.push_back(entry.second->timestamp_ns);
+  }
+  BatchIndex::instance().add(stamps);
+
+  ++num_batches_;
+  num_filled_ = 0;
+  return batch;
+}
+
+}  // namespace hydra
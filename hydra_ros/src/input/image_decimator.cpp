@@ -0,0 +1,182 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/image_decimator.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace hydra {
+
+void declare_config(ImageDecimator::Config& config) {
+  using namespace config;
+  name("ImageDecimator::Config");
+  field(config.stride, "stride");
+  field(config.min_pool_depth, "min_pool_depth");
+  field(config.roi_x, "roi_x");
+  field(config.roi_y, "roi_y");
+  field(config.roi_width, "roi_width");
+  field(config.roi_height, "roi_height");
+  check(config.stride, GE, 1, "stride");
+  check(config.roi_x, GE, 0, "roi_x");
+  check(config.roi_y, GE, 0, "roi_y");
+}
+
+namespace {
+
+inline int decimatedSize(int size, int stride) { return (size + stride - 1) / stride; }
+
+inline bool validDepth(uint16_t depth) { return depth > 0; }
+
+inline bool validDepth(float depth) { return std::isfinite(depth) && depth > 0.0f; }
+
+template <typename T>
+void minPool(const cv::Mat& image, int stride, cv::Mat& result) {
+  for (int r = 0; r < result.rows; ++r) {
+    auto out = result.ptr<T>(r);
+    const int row_end = std::min((r + 1) * stride, image.rows);
+    for (int c = 0; c < result.cols; ++c) {
+      const int col_start = c * stride;
+      const int col_end = std::min(col_start + stride, image.cols);
+      // fall back to the nearest value if the window has no valid depth
+      T best = image.at<T>(r * stride, col_start);
+      bool have_valid = false;
+      for (int row = r * stride; row < row_end; ++row) {
+        const auto in = image.ptr<T>(row);
+        for (int col = col_start; col < col_end; ++col) {
+          const T value = in[col];
+          if (validDepth(value) && (!have_valid || value < best)) {
+            best = value;
+            have_valid = true;
+          }
+        }
+      }
+
+      out[c] = best;
+    }
+  }
+}
+
+}  // namespace
+
+ImageDecimator::ImageDecimator(const Config& config)
+    : config(config::checkValid(config)) {}
+
+bool ImageDecimator::enabled() const {
+  return config.stride > 1 || config.roi_x > 0 || config.roi_y > 0 ||
+         config.roi_width > 0 || config.roi_height > 0;
+}
+
+cv::Rect ImageDecimator::roi(int width, int height) const {
+  const int x = std::min(config.roi_x, width);
+  const int y = std::min(config.roi_y, height);
+  const int roi_width = config.roi_width > 0 ? config.roi_width : width - x;
+  const int roi_height = config.roi_height > 0 ? config.roi_height : height - y;
+  return cv::Rect(
+      x, y, std::min(roi_width, width - x), std::min(roi_height, height - y));
+}
+
+cv::Mat ImageDecimator::depth(const cv::Mat& image) const {
+  if (image.empty() || !config.min_pool_depth || config.stride == 1) {
+    return nearest(image);
+  }
+
+  const cv::Mat cropped = image(roi(image.cols, image.rows));
+  cv::Mat result(decimatedSize(cropped.rows, config.stride),
+                 decimatedSize(cropped.cols, config.stride),
+                 cropped.type());
+  switch (cropped.type()) {
+    case CV_16UC1:
+      minPool<uint16_t>(cropped, config.stride, result);
+      break;
+    case CV_32FC1:
+      minPool<float>(cropped, config.stride, result);
+      break;
+    default:
+      LOG(WARNING) << "Unsupported depth type for min-pooling: " << cropped.type()
+                   << ". Using nearest sampling";
+      return nearest(image);
+  }
+
+  return result;
+}
+
+cv::Mat ImageDecimator::nearest(const cv::Mat& image) const {
+  if (image.empty()) {
+    return image;
+  }
+
+  const cv::Mat cropped = image(roi(image.cols, image.rows));
+  if (config.stride == 1) {
+    return cropped;
+  }
+
+  cv::Mat result(decimatedSize(cropped.rows, config.stride),
+                 decimatedSize(cropped.cols, config.stride),
+                 cropped.type());
+  const size_t elem_size = cropped.elemSize();
+  for (int r = 0; r < result.rows; ++r) {
+    const auto in = cropped.ptr<uint8_t>(r * config.stride);
+    auto out = result.ptr<uint8_t>(r);
+    for (int c = 0; c < result.cols; ++c) {
+      std::memcpy(out + c * elem_size, in + c * config.stride * elem_size, elem_size);
+    }
+  }
+
+  return result;
+}
+
+void ImageDecimator::scaleIntrinsics(Camera::Config& cam_config) const {
+  if (!enabled()) {
+    return;
+  }
+
+  const auto bounds =
+      roi(static_cast<int>(cam_config.width), static_cast<int>(cam_config.height));
+  const double stride = config.stride;
+  // pixel i of the decimated image is pixel roi_x + stride * i of the original
+  cam_config.cx = (cam_config.cx - bounds.x) / stride;
+  cam_config.cy = (cam_config.cy - bounds.y) / stride;
+  cam_config.fx /= stride;
+  cam_config.fy /= stride;
+  cam_config.width = decimatedSize(bounds.width, config.stride);
+  cam_config.height = decimatedSize(bounds.height, config.stride);
+}
+
+}  // namespace hydra
@@ -38,6 +38,10 @@
 #include <cv_bridge/cv_bridge.h>
 #include <glog/logging.h>
 
+#include "hydra_ros/utils/compressed_image.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/shared_image.h"
+
 namespace hydra {
 
 using image_transport::ImageTransport;
@@ -52,9 +56,15 @@ image_transport::TransportHints getHintsWithNamespace(const ros::NodeHandle& nh,
 void declare_config(ImageReceiver::Config& config) {
   using namespace config;
   name("ImageReceiver::Config");
-  base<DataReceiver::Config>(config);
+  base<RosDataReceiver::Config>(config);
   field(config.ns, "ns");
   field(config.queue_size, "queue_size");
+  field(config.decimation, "decimation");
+  field(config.batch_group, "batch_group");
+  field(config.batch_window_s, "batch_window_s");
+  field(config.compressed, "compressed");
+  field(config.decoding, "decoding");
+  check(config.batch_window_s, GE, 0.0, "batch_window_s");
 }
 
 ImageSubscriber::ImageSubscriber() {}
@@ -69,9 +79,39 @@ ImageSubscriber::ImageSubscriber(const ros::NodeHandle& nh,
 }
 
 ImageReceiver::ImageReceiver(const Config& config, size_t sensor_id)
-    : DataReceiver(config, sensor_id), config(config), nh_(config.ns) {}
+    : RosDataReceiver(config, sensor_id),
+      config(config),
+      nh_(getNodeHandle(config.ns)),
+      bytes_copied_(0),
+      decimator_(config.decimation),
+      batch_slot_(0) {
+  if (!config.batch_group.empty()) {
+    batcher_ = ImageBatcher::getGroup(config.batch_group, config.batch_window_s);
+    batch_slot_ = batcher_->addCamera(
+        [this](const InputPacket::Ptr& packet) { pushPacket(packet); });
+  }
+}
 
 bool ImageReceiver::initImpl() {
+  if (config.compressed) {
+    decode_stage_ = std::make_unique<DecodeStage>(config.decoding);
+    // subscribes to the compressed topics directly so that image_transport does not
+    // decode on the callback thread
+    const auto size = config.queue_size;
+    color_compressed_sub_.subscribe(nh_, "rgb/image_raw/compressed", size);
+    depth_compressed_sub_.subscribe(
+        nh_, "depth_registered/image_rect/compressedDepth", size);
+    label_compressed_sub_.subscribe(nh_, "semantic/image_raw/compressed", size);
+    compressed_synchronizer_.reset(
+        new CompressedSynchronizer(CompressedSyncPolicy(config.queue_size),
+                                   color_compressed_sub_,
+                                   depth_compressed_sub_,
+                                   label_compressed_sub_));
+    compressed_synchronizer_->registerCallback(&ImageReceiver::compressedCallback,
+                                               this);
+    return true;
+  }
+
   // TODO(nathan) subscribe to image subsets
   color_sub_ = ImageSubscriber(nh_, "rgb");
   depth_sub_ = ImageSubscriber(nh_, "depth_registered", "image_rect");
@@ -84,7 +124,13 @@ bool ImageReceiver::initImpl() {
   return true;
 }
 
-ImageReceiver::~ImageReceiver() {}
+ImageReceiver::~ImageReceiver() {
+  // delivers any packets still being decoded
+  decode_stage_.reset();
+  if (batcher_) {
+    batcher_->removeCamera(batch_slot_);
+  }
+}
 
 std::string showImageDim(const sensor_msgs::Image::ConstPtr& image) {
   std::stringstream ss;
@@ -107,31 +153,101 @@ void ImageReceiver::callback(const sensor_msgs::Image::ConstPtr& color,
     return;
   }
 
-  if (!checkInputTimestamp(depth->header.stamp.toNSec())) {
+  const auto timestamp_ns = depth->header.stamp.toNSec();
+  if (!checkInputTimestamp(timestamp_ns) || !admitMessage(timestamp_ns)) {
     return;
   }
 
   auto packet = std::make_shared<ImageInputPacket>(color->header.stamp.toNSec(), sensor_id_);
+  // images alias the message buffers whenever the encoding allows it
+  size_t bytes_copied = 0;
+  size_t bytes_total = 0;
+  const auto track = [&](const ImageView& view) {
+    bytes_copied += view.bytes_copied;
+    bytes_total += view.image.total() * view.image.elemSize();
+    return view.image;
+  };
+
   try {
-    const auto cv_depth = cv_bridge::toCvShare(depth);
-    packet->depth = cv_depth->image.clone();
-    if (color && color->encoding == sensor_msgs::image_encodings::RGB8) {
-      auto cv_color = cv_bridge::toCvShare(color);
-      packet->color = cv_color->image.clone();
-    } else if (color) {
-      auto cv_color = cv_bridge::toCvCopy(color, sensor_msgs::image_encodings::RGB8);
-      packet->color = cv_color->image;
+    packet->depth = track(viewImage(depth));
+    if (color) {
+      packet->color = track(viewImage(color, sensor_msgs::image_encodings::RGB8));
     }
 
     if (labels) {
-      auto cv_labels = cv_bridge::toCvShare(labels);
-      packet->labels = cv_labels->image.clone();
+      packet->labels = track(viewImage(labels));
     }
   } catch (const cv_bridge::Exception& e) {
     LOG(ERROR) << "unable to read images from ros: " << e.what();
   }
 
-  queue.push(packet);
+  decimate(*packet);
+
+  bytes_copied_ += bytes_copied;
+  VLOG(2) << "[ImageReceiver] copied " << bytes_copied << " bytes for frame @ "
+          << packet->timestamp_ns << " [ns] (full copy would be " << bytes_total
+          << " bytes, " << bytes_copied_ << " bytes total)";
+
+  dispatch(packet);
+}
+
+void ImageReceiver::compressedCallback(
+    const sensor_msgs::CompressedImage::ConstPtr& color,
+    const sensor_msgs::CompressedImage::ConstPtr& depth,
+    const sensor_msgs::CompressedImage::ConstPtr& labels) {
+  const auto timestamp_ns = depth->header.stamp.toNSec();
+  if (!checkInputTimestamp(timestamp_ns) || !admitMessage(timestamp_ns)) {
+    return;
+  }
+
+  // decoding happens on the stage threads and packets are delivered in order
+  decode_stage_->submit(
+      timestamp_ns, [this, timestamp_ns, color, depth, labels]() {
+        auto packet = std::make_shared<ImageInputPacket>(timestamp_ns, sensor_id_);
+        packet->depth = decodeCompressedImage(*depth);
+        if (color) {
+          packet->color = decodeCompressedImage(*color, true);
+        }
+
+        if (labels) {
+          packet->labels = decodeCompressedImage(*labels);
+        }
+
+        if (packet->depth.empty() || (color && packet->color.empty()) ||
+            (labels && packet->labels.empty())) {
+          LOG(ERROR) << "unable to decode images @ " << timestamp_ns << " [ns]";
+          return DecodeStage::Continuation();
+        }
+
+        if ((color && packet->color.size() != packet->depth.size()) ||
+            (labels && packet->labels.size() != packet->depth.size())) {
+          LOG(ERROR) << "decoded image dimensions do not match depth dimensions @ "
+                     << timestamp_ns << " [ns]";
+          return DecodeStage::Continuation();
+        }
+
+        decimate(*packet);
+        return DecodeStage::Continuation([this, packet]() { dispatch(packet); });
+      });
+}
+
+void ImageReceiver::decimate(ImageInputPacket& packet) const {
+  if (!decimator_.enabled()) {
+    return;
+  }
+
+  packet.depth = decimator_.depth(packet.depth);
+  packet.color = decimator_.nearest(packet.color);
+  packet.labels = decimator_.nearest(packet.labels);
+}
+
+void ImageReceiver::dispatch(const InputPacket::Ptr& packet) {
+  if (batcher_) {
+    batcher_->submit(batch_slot_, packet);
+    return;
+  }
+
+  pushPacket(packet);
 }
 
 }  // namespace hydra
@@ -36,6 +36,11 @@
 
 #include <glog/logging.h>
 
+#include <cstring>
+#include <type_traits>
+
+#include "hydra_ros/utils/worker_pool.h"
+
 namespace hydra {
 
 template <typename T>
@@ -237,21 +242,12 @@ uint32_t PointcloudAdaptor::label(const uint8_t* point_ptr) const {
   return label_parser_(point_ptr);
 }
 
-bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
-                          CloudInputPacket& packet,
-                          bool labels_required) {
-  PointcloudAdaptor adaptor(msg);
-  if (!adaptor.valid() || (!adaptor.hasLabels() && labels_required)) {
-    return false;
-  }
-
-  packet.points = cv::Mat(msg.height, msg.width, CV_32FC3);
-  packet.colors = cv::Mat(msg.height, msg.width, CV_8UC3);
-  if (adaptor.hasLabels()) {
-    packet.labels = cv::Mat(msg.height, msg.width, CV_32SC1);
-  }
-
-  for (uint32_t row = 0; row < msg.height; ++row) {
+void decodeRowsGeneric(const sensor_msgs::PointCloud2& msg,
+                       const PointcloudAdaptor& adaptor,
+                       CloudInputPacket& packet,
+                       uint32_t row_start,
+                       uint32_t row_end) {
+  for (uint32_t row = row_start; row < row_end; ++row) {
     for (uint32_t col = 0; col < msg.width; ++col) {
       const auto offset = row * msg.row_step + col * msg.point_step;
       const auto point_ptr = &msg.data[offset];
@@ -262,6 +258,278 @@ bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
       }
     }
   }
+}
+
+void allocatePacket(const sensor_msgs::PointCloud2& msg,
+                    CloudInputPacket& packet,
+                    bool has_labels) {
+  packet.points = cv::Mat(msg.height, msg.width, CV_32FC3);
+  packet.colors = cv::Mat(msg.height, msg.width, CV_8UC3);
+  if (has_labels) {
+    packet.labels = cv::Mat(msg.height, msg.width, CV_32SC1);
+  }
+}
+
+void runRows(const sensor_msgs::PointCloud2& msg,
+             WorkerPool* pool,
+             const std::function<void(size_t, size_t)>& decode) {
+  if (!pool) {
+    decode(0, msg.height);
+    return;
+  }
+
+  pool->parallelFor(msg.height, decode);
+}
+
+bool fillPointcloudPacketGeneric(const sensor_msgs::PointCloud2& msg,
+                                 CloudInputPacket& packet,
+                                 bool labels_required) {
+  PointcloudAdaptor adaptor(msg);
+  if (!adaptor.valid() || (!adaptor.hasLabels() && labels_required)) {
+    return false;
+  }
+
+  allocatePacket(msg, packet, adaptor.hasLabels());
+  decodeRowsGeneric(msg, adaptor, packet, 0, msg.height);
+  return true;
+}
+
+std::ostream& operator<<(std::ostream& out, PointcloudLayout layout) {
+  switch (layout) {
+    case PointcloudLayout::XYZ:
+      return out << "XYZ";
+    case PointcloudLayout::XYZ_RGB:
+      return out << "XYZ_RGB";
+    case PointcloudLayout::XYZ_INTENSITY_RING:
+      return out << "XYZ_INTENSITY_RING";
+    case PointcloudLayout::XYZ_LABEL:
+      return out << "XYZ_LABEL";
+    case PointcloudLayout::XYZ_RGB_LABEL:
+      return out << "XYZ_RGB_LABEL";
+    case PointcloudLayout::GENERIC:
+    default:
+      return out << "GENERIC";
+  }
+}
+
+inline bool isPackedFloat(const PointField& field, uint32_t offset) {
+  return field.datatype == PointField::FLOAT32 && field.offset == offset &&
+         field.count <= 1;
+}
+
+inline bool isIntField(const PointField& field) {
+  switch (field.datatype) {
+    case PointField::INT8:
+    case PointField::UINT8:
+    case PointField::INT16:
+    case PointField::UINT16:
+    case PointField::INT32:
+    case PointField::UINT32:
+      return true;
+    default:
+      return false;
+  }
+}
+
+PointcloudLayoutInfo detectPointcloudLayout(const sensor_msgs::PointCloud2& msg) {
+  PointcloudLayoutInfo info;
+  if (msg.is_bigendian || msg.point_step < 3 * sizeof(float)) {
+    return info;
+  }
+
+  bool has_x = false;
+  bool has_y = false;
+  bool has_z = false;
+  bool has_intensity = false;
+  // mirrors the field matching in PointcloudAdaptor: if any field would be parsed
+  // differently by the specialized loop we bail out to the generic path
+  for (const auto& field : msg.fields) {
+    if (field.name == "x") {
+      has_x = isPackedFloat(field, 0);
+      if (!has_x) {
+        return {};
+      }
+    } else if (field.name == "y") {
+      has_y = isPackedFloat(field, 4);
+      if (!has_y) {
+        return {};
+      }
+    } else if (field.name == "z") {
+      has_z = isPackedFloat(field, 8);
+      if (!has_z) {
+        return {};
+      }
+    } else if (field.name == "rgb" || field.name == "rgba") {
+      if (field.datatype != PointField::FLOAT32 &&
+          field.datatype != PointField::UINT32) {
+        return {};
+      }
+      info.has_color = true;
+      info.color_offset = field.offset;
+    } else if (field.name == "label" || field.name == "ring") {
+      if (!isIntField(field)) {
+        return {};
+      }
+      info.has_label = true;
+      info.label_offset = field.offset;
+      info.label_datatype = field.datatype;
+    } else if (field.name == "intensity") {
+      has_intensity = true;
+    }
+  }
+
+  if (!has_x || !has_y || !has_z) {
+    return {};
+  }
+
+  if (info.has_color && info.has_label) {
+    info.layout = PointcloudLayout::XYZ_RGB_LABEL;
+  } else if (info.has_color) {
+    info.layout = PointcloudLayout::XYZ_RGB;
+  } else if (info.has_label) {
+    info.layout = has_intensity ? PointcloudLayout::XYZ_INTENSITY_RING
+                                : PointcloudLayout::XYZ_LABEL;
+  } else {
+    info.layout = PointcloudLayout::XYZ;
+  }
+
+  return info;
+}
+
+namespace {
+
+struct NoLabel {};
+
+template <typename T>
+inline T readField(const uint8_t* ptr) {
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+/**
+ * @brief Decoding loop for a fixed field layout
+ *
+ * All per-field dispatch is resolved at compile time, so the inner loop is a set of
+ * strided loads that the compiler can vectorize. When the points are tightly packed
+ * xyz (i.e., the row is already laid out like a CV_32FC3 row), positions are copied
+ * with a single memcpy per row.
+ */
+template <bool HasColor, typename LabelT>
+void decodeRows(const sensor_msgs::PointCloud2& msg,
+                const PointcloudLayoutInfo& info,
+                CloudInputPacket& packet,
+                uint32_t row_start,
+                uint32_t row_end) {
+  constexpr bool has_label = !std::is_same_v<LabelT, NoLabel>;
+  constexpr size_t xyz_bytes = 3 * sizeof(float);
+  const size_t step = msg.point_step;
+  const bool packed_xyz = step == xyz_bytes;
+
+  for (uint32_t row = row_start; row < row_end; ++row) {
+    const uint8_t* row_ptr = msg.data.data() + static_cast<size_t>(row) * msg.row_step;
+    float* points = packet.points.ptr<float>(row);
+    if (packed_xyz) {
+      std::memcpy(points, row_ptr, msg.width * xyz_bytes);
+    } else {
+      for (uint32_t col = 0; col < msg.width; ++col) {
+        std::memcpy(points + 3 * col, row_ptr + col * step, xyz_bytes);
+      }
+    }
+
+    uint8_t* colors = packet.colors.ptr<uint8_t>(row);
+    if constexpr (HasColor) {
+      const uint8_t* color_ptr = row_ptr + info.color_offset;
+      for (uint32_t col = 0; col < msg.width; ++col) {
+        // packed rgb is stored as bgra in memory
+        const uint8_t* bgra = color_ptr + col * step;
+        colors[3 * col] = bgra[2];
+        colors[3 * col + 1] = bgra[1];
+        colors[3 * col + 2] = bgra[0];
+      }
+    } else {
+      std::memset(colors, 0, 3 * msg.width);
+    }
+
+    if constexpr (has_label) {
+      const uint8_t* label_ptr = row_ptr + info.label_offset;
+      int32_t* labels = packet.labels.ptr<int32_t>(row);
+      for (uint32_t col = 0; col < msg.width; ++col) {
+        // matches PointcloudAdaptor::label (cast through uint32_t)
+        const auto value = readField<LabelT>(label_ptr + col * step);
+        labels[col] = static_cast<int32_t>(static_cast<uint32_t>(value));
+      }
+    }
+  }
+}
+
+template <bool HasColor>
+void decodeRowsWithLabel(const sensor_msgs::PointCloud2& msg,
+                         const PointcloudLayoutInfo& info,
+                         CloudInputPacket& packet,
+                         uint32_t row_start,
+                         uint32_t row_end) {
+  if (!info.has_label) {
+    decodeRows<HasColor, NoLabel>(msg, info, packet, row_start, row_end);
+    return;
+  }
+
+  switch (info.label_datatype) {
+    case PointField::INT8:
+      decodeRows<HasColor, int8_t>(msg, info, packet, row_start, row_end);
+      break;
+    case PointField::UINT8:
+      decodeRows<HasColor, uint8_t>(msg, info, packet, row_start, row_end);
+      break;
+    case PointField::INT16:
+      decodeRows<HasColor, int16_t>(msg, info, packet, row_start, row_end);
+      break;
+    case PointField::UINT16:
+      decodeRows<HasColor, uint16_t>(msg, info, packet, row_start, row_end);
+      break;
+    case PointField::INT32:
+      decodeRows<HasColor, int32_t>(msg, info, packet, row_start, row_end);
+      break;
+    case PointField::UINT32:
+    default:
+      decodeRows<HasColor, uint32_t>(msg, info, packet, row_start, row_end);
+      break;
+  }
+}
+
+}  // namespace
+
+bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
+                          CloudInputPacket& packet,
+                          bool labels_required,
+                          WorkerPool* pool) {
+  const auto info = detectPointcloudLayout(msg);
+  VLOG(10) << "detected pointcloud layout: " << info.layout;
+  if (info.layout == PointcloudLayout::GENERIC) {
+    PointcloudAdaptor adaptor(msg);
+    if (!adaptor.valid() || (!adaptor.hasLabels() && labels_required)) {
+      return false;
+    }
+
+    allocatePacket(msg, packet, adaptor.hasLabels());
+    runRows(msg, pool, [&](size_t start, size_t end) {
+      decodeRowsGeneric(msg, adaptor, packet, start, end);
+    });
+    return true;
+  }
+
+  if (!info.has_label && labels_required) {
+    return false;
+  }
+
+  allocatePacket(msg, packet, info.has_label);
+  runRows(msg, pool, [&](size_t start, size_t end) {
+    if (info.has_color) {
+      decodeRowsWithLabel<true>(msg, info, packet, start, end);
+    } else {
+      decodeRowsWithLabel<false>(msg, info, packet, start, end);
+    }
+  });
 
   return true;
 }
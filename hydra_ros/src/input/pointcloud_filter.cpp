@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/pointcloud_filter.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+namespace hydra {
+
+void declare_config(PointcloudFilter::Config& config) {
+  using namespace config;
+  name("PointcloudFilter::Config");
+  field(config.min_range, "min_range");
+  field(config.max_range, "max_range");
+  field(config.min_z, "min_z");
+  field(config.max_z, "max_z");
+  field(config.voxel_size, "voxel_size");
+  check(config.min_range, GE, 0.0f, "min_range");
+  checkCondition(config.min_z <= config.max_z, "min_z must be less than max_z");
+}
+
+namespace {
+
+// packs the voxel index into 21 bits per axis, which covers +/- 1e6 voxels
+inline uint64_t voxelKey(const cv::Vec3f& point, float voxel_scale) {
+  constexpr int64_t offset = 1 << 20;
+  constexpr uint64_t mask = (1 << 21) - 1;
+  const auto x = static_cast<int64_t>(std::floor(point[0] * voxel_scale)) + offset;
+  const auto y = static_cast<int64_t>(std::floor(point[1] * voxel_scale)) + offset;
+  const auto z = static_cast<int64_t>(std::floor(point[2] * voxel_scale)) + offset;
+  return (static_cast<uint64_t>(x) & mask) |
+         ((static_cast<uint64_t>(y) & mask) << 21) |
+         ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+}  // namespace
+
+PointcloudFilter::PointcloudFilter(const Config& config)
+    : config(config::checkValid(config)) {}
+
+bool PointcloudFilter::enabled() const {
+  return config.min_range > 0.0f || config.max_range > 0.0f ||
+         config.voxel_size > 0.0f || std::isfinite(config.min_z) ||
+         std::isfinite(config.max_z);
+}
+
+size_t PointcloudFilter::filter(CloudInputPacket& packet) const {
+  const size_t num_points = packet.points.total();
+  const bool has_colors = !packet.colors.empty();
+  const bool has_labels = !packet.labels.empty();
+
+  // points are continuous since the decoder allocates the matrices directly
+  CHECK(packet.points.isContinuous());
+  const auto points = packet.points.ptr<cv::Vec3f>();
+  const auto colors = has_colors ? packet.colors.ptr<cv::Vec3b>() : nullptr;
+  const auto labels = has_labels ? packet.labels.ptr<int32_t>() : nullptr;
+
+  // range and height are relative to the sensor, which is not the origin of clouds
+  // that are already in the world frame
+  const bool sensor_frame = !packet.in_world_frame;
+  const float min_range_sq = config.min_range * config.min_range;
+  const float max_range_sq = config.max_range > 0.0f
+                                 ? config.max_range * config.max_range
+                                 : std::numeric_limits<float>::infinity();
+  const bool use_voxels = config.voxel_size > 0.0f;
+  const float voxel_scale = use_voxels ? 1.0f / config.voxel_size : 0.0f;
+
+  std::unordered_set<uint64_t> occupied;
+  if (use_voxels) {
+    occupied.reserve(num_points / 4);
+  }
+
+  // compacts the kept points to the front of the buffers in a single pass
+  size_t num_kept = 0;
+  for (size_t i = 0; i < num_points; ++i) {
+    const auto& p = points[i];
+    if (!std::isfinite(p[0]) || !std::isfinite(p[1]) || !std::isfinite(p[2])) {
+      continue;
+    }
+
+    if (sensor_frame) {
+      const float range_sq = p.dot(p);
+      if (range_sq < min_range_sq || range_sq > max_range_sq || p[2] < config.min_z ||
+          p[2] > config.max_z) {
+        continue;
+      }
+    }
+
+    if (use_voxels && !occupied.insert(voxelKey(p, voxel_scale)).second) {
+      continue;
+    }
+
+    points[num_kept] = p;
+    if (colors) {
+      colors[num_kept] = colors[i];
+    }
+    if (labels) {
+      labels[num_kept] = labels[i];
+    }
+
+    ++num_kept;
+  }
+
+  // shrink to a single row of kept points (header change only, no reallocation)
+  const auto num_cols = static_cast<int>(num_kept);
+  packet.points = packet.points.reshape(0, 1).colRange(0, num_cols);
+  if (has_colors) {
+    packet.colors = packet.colors.reshape(0, 1).colRange(0, num_cols);
+  }
+  if (has_labels) {
+    packet.labels = packet.labels.reshape(0, 1).colRange(0, num_cols);
+  }
+
+  return num_kept;
+}
+
+}  // namespace hydra
@@ -1,15 +1,38 @@
 #include "hydra_ros/input/pointcloud_receiver.h"
 
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
 #include <glog/logging.h>
 #include <hydra/common/common.h>
 #include <hydra/common/global_info.h>
 
 #include "hydra_ros/input/pointcloud_adaptor.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/worker_pool.h"
 
 namespace hydra {
 
+void declare_config(PointcloudReceiver::Config& config) {
+  using namespace config;
+  name("PointcloudReceiver::Config");
+  base<RosDataReceiver::Config>(config);
+  field(config.ns, "ns");
+  field(config.queue_size, "queue_size");
+  field(config.num_decode_threads, "num_decode_threads");
+  field(config.filter, "filter");
+  checkCondition(config.num_decode_threads > 0, "num_decode_threads must be positive");
+}
+
 PointcloudReceiver::PointcloudReceiver(const Config& config, size_t sensor_id)
-    : DataReceiver(config, sensor_id), nh_(config.ns) {}
+    : RosDataReceiver(config, sensor_id),
+      config(config::checkValid(config)),
+      nh_(getNodeHandle(config.ns)),
+      filter_(config.filter) {
+  if (config.num_decode_threads > 1) {
+    // the callback thread decodes one chunk of rows itself
+    decode_pool_ = std::make_unique<WorkerPool>(config.num_decode_threads - 1);
+  }
+}
 
 PointcloudReceiver::~PointcloudReceiver() {}
 
@@ -19,21 +42,36 @@ bool PointcloudReceiver::initImpl() {
   return true;
 }
 
-void PointcloudReceiver::callback(const sensor_msgs::PointCloud2& msg) {
+void PointcloudReceiver::callback(const sensor_msgs::PointCloud2::ConstPtr& cloud) {
+  // taking a ConstPtr avoids a copy when the publisher shares our process (nodelets)
+  const auto& msg = *cloud;
   const auto timestamp_ns = msg.header.stamp.toNSec();
   VLOG(5) << "[Hydra Reconstruction] Got raw pointcloud input @ " << timestamp_ns
           << " [ns]";
 
-  if (!checkInputTimestamp(timestamp_ns)) {
+  if (!checkInputTimestamp(timestamp_ns) || !admitMessage(timestamp_ns)) {
     return;
   }
 
   auto packet = std::make_shared<CloudInputPacket>(timestamp_ns, sensor_id_);
-  fillPointcloudPacket(msg, *packet, false);
+  if (!fillPointcloudPacket(msg, *packet, false, decode_pool_.get())) {
+    LOG(ERROR) << "Unable to decode pointcloud @ " << timestamp_ns << " [ns]";
+    return;
+  }
+
   // TODO(nathan) this is brittle, but at least handles kitti
   packet->in_world_frame =
       msg.header.frame_id == GlobalInfo::instance().getFrames().odom;
-  queue.push(packet);
+  if (filter_.enabled()) {
+    const auto num_points = packet->points.total();
+    const auto num_kept = filter_.filter(*packet);
+    VLOG(1) << "[PointcloudReceiver] kept " << num_kept << " / " << num_points
+            << " points (reduction ratio: "
+            << (num_kept ? static_cast<double>(num_points) / num_kept : 0.0)
+            << ") @ " << timestamp_ns << " [ns]";
+  }
+
+  pushPacket(packet);
 }
 
 }  // namespace hydra
@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/ros_data_receiver.h"
+
+#include <config_utilities/config.h>
+#include <glog/logging.h>
+
+namespace hydra {
+
+void declare_config(RosDataReceiver::Config& config) {
+  using namespace config;
+  name("RosDataReceiver::Config");
+  base<DataReceiver::Config>(config);
+  field(config.backpressure, "backpressure");
+}
+
+RosDataReceiver::RosDataReceiver(const Config& config, size_t sensor_id)
+    : DataReceiver(config, sensor_id), backpressure_(config.backpressure) {}
+
+RosDataReceiver::~RosDataReceiver() = default;
+
+void RosDataReceiver::setPacketGate(const TfPacketGate::Ptr& gate) { gate_ = gate; }
+
+void RosDataReceiver::setDownstreamDepth(const DepthFunction& depth) {
+  downstream_depth_ = depth;
+}
+
+RosDataReceiver::Stats RosDataReceiver::stats() const {
+  Stats stats;
+  stats.sensor_id = sensor_id_;
+  stats.queue_depth = queue.size();
+  stats.num_received = backpressure_.numReceived();
+  stats.num_dropped = backpressure_.numDropped();
+  return stats;
+}
+
+bool RosDataReceiver::admitMessage(uint64_t timestamp_ns) {
+  const size_t receiver_depth = queue.size();
+  const size_t downstream_depth = downstream_depth_ ? downstream_depth_() : 0;
+  const auto decision = backpressure_.update(receiver_depth, downstream_depth);
+  if (decision.clear_queue) {
+    VLOG(1) << "[RosDataReceiver] sensor " << sensor_id_ << " dropping "
+            << receiver_depth << " queued packets for packet @ " << timestamp_ns
+            << " [ns]";
+    queue.clear();
+  }
+
+  if (!decision.keep) {
+    VLOG(1) << "[RosDataReceiver] sensor " << sensor_id_ << " dropping packet @ "
+            << timestamp_ns << " [ns] (queue depth: "
+            << receiver_depth + downstream_depth << ")";
+  }
+
+  return decision.keep;
+}
+
+void RosDataReceiver::pushPacket(const InputPacket::Ptr& packet) {
+  if (!gate_) {
+    queue.push(packet);
+    return;
+  }
+
+  gate_->submit(packet, [this](const InputPacket::Ptr& ready) { queue.push(ready); });
+}
+
+}  // namespace hydra
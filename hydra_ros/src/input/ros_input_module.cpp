@@ -39,7 +39,10 @@
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
 
+#include "hydra_ros/input/image_batcher.h"
+#include "hydra_ros/input/ros_data_receiver.h"
 #include "hydra_ros/utils/lookup_tf.h"
+#include "hydra_ros/utils/node_utilities.h"
 
 namespace hydra {
 
@@ -53,20 +56,56 @@ void declare_config(RosInputModule::Config& config) {
   field(config.tf_buffer_size_s, "tf_buffer_size_s");
   field(config.tf_max_tries, "tf_max_tries");
   field(config.tf_verbosity, "tf_verbosity");
+  field(config.tf_max_deferral_s, "tf_max_deferral_s");
+  field(config.share_batch_pose, "share_batch_pose");
+  field(config.diagnostics_period_s, "diagnostics_period_s");
 }
 
 RosInputModule::RosInputModule(const Config& config, const OutputQueue::Ptr& queue)
     : InputModule(config, queue),
       config(config),
-      nh_(ros::NodeHandle(config.ns)),
+      nh_(getNodeHandle(config.ns)),
       have_first_pose_(false) {
   buffer_.reset(new tf2_ros::Buffer(ros::Duration(config.tf_buffer_size_s)));
   tf_listener_.reset(new tf2_ros::TransformListener(*buffer_));
+  if (config.tf_max_deferral_s > 0.0) {
+    // packets wait in the gate instead of blocking the input thread on tf lookups
+    const auto& frames = GlobalInfo::instance().getFrames();
+    tf_gate_ = std::make_shared<TfPacketGate>(
+        *buffer_, frames.odom, frames.robot, config.tf_max_deferral_s);
+  }
+
+  for (auto& receiver : receivers_) {
+    auto ros_receiver = dynamic_cast<RosDataReceiver*>(receiver.get());
+    if (!ros_receiver) {
+      continue;
+    }
+
+    ros_receivers_.push_back(ros_receiver);
+    ros_receiver->setPacketGate(tf_gate_);
+    // queue is the reconstruction input queue
+    ros_receiver->setDownstreamDepth([queue]() { return queue ? queue->size() : 0; });
+  }
+
+  if (config.diagnostics_period_s > 0.0) {
+    diagnostics_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>(
+        "input_diagnostics", 1);
+    diagnostics_timer_ =
+        nh_.createWallTimer(ros::WallDuration(config.diagnostics_period_s),
+                            [this, queue](const ros::WallTimerEvent&) {
+                              publishDiagnostics(queue ? queue->size() : 0);
+                            });
+  }
   // print config
   // LOG(INFO) << printInfo();
 }
 
-RosInputModule::~RosInputModule() = default;
+RosInputModule::~RosInputModule() {
+  if (tf_gate_) {
+    // receivers may outlive the tf buffer and keep the gate alive
+    tf_gate_->shutdown();
+  }
+}
 
 std::string RosInputModule::printInfo() const {
   std::stringstream ss;
@@ -74,7 +113,68 @@ std::string RosInputModule::printInfo() const {
   return ss.str();
 }
 
+template <typename T>
+void addValue(diagnostic_msgs::DiagnosticStatus& status,
+              const std::string& key,
+              const T& value) {
+  diagnostic_msgs::KeyValue pair;
+  pair.key = key;
+  pair.value = std::to_string(value);
+  status.values.push_back(pair);
+}
+
+void RosInputModule::publishDiagnostics(size_t reconstruction_depth) {
+  diagnostic_msgs::DiagnosticArray msg;
+  msg.header.stamp = ros::Time::now();
+
+  diagnostic_msgs::DiagnosticStatus reconstruction;
+  reconstruction.name = "hydra/reconstruction_queue";
+  reconstruction.hardware_id = "hydra";
+  reconstruction.level = diagnostic_msgs::DiagnosticStatus::OK;
+  reconstruction.message = "ok";
+  addValue(reconstruction, "queue_depth", reconstruction_depth);
+  if (tf_gate_) {
+    addValue(reconstruction, "tf_pending", tf_gate_->numPending());
+    addValue(reconstruction, "tf_dropped", tf_gate_->numDropped());
+  }
+  msg.status.push_back(reconstruction);
+
+  for (const auto receiver : ros_receivers_) {
+    const auto stats = receiver->stats();
+    const auto& policy = receiver->backpressure();
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = "hydra/input/sensor_" + std::to_string(stats.sensor_id);
+    status.hardware_id = "hydra";
+    const auto depth = stats.queue_depth + reconstruction_depth;
+    const bool backlogged = depth > policy.config.max_queue_depth;
+    status.level = backlogged ? diagnostic_msgs::DiagnosticStatus::WARN
+                              : diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = backlogged ? "backlogged" : "ok";
+    addValue(status, "queue_depth", stats.queue_depth);
+    addValue(status, "received", stats.num_received);
+    addValue(status, "dropped", stats.num_dropped);
+    diagnostic_msgs::KeyValue mode;
+    mode.key = "policy";
+    std::stringstream ss;
+    ss << policy.mode();
+    mode.value = ss.str();
+    status.values.push_back(mode);
+    msg.status.push_back(status);
+  }
+
+  diagnostics_pub_.publish(msg);
+}
+
 PoseStatus RosInputModule::getBodyPose(uint64_t timestamp_ns) {
+  // batched cameras share a single lookup
+  const auto batch =
+      config.share_batch_pose ? ImageBatcher::findBatch(timestamp_ns) : std::nullopt;
+  if (batch && last_pose_ && last_pose_->first == *batch) {
+    VLOG(config.tf_verbosity) << "Reusing pose of batch " << *batch << " for "
+                              << timestamp_ns << " [ns]";
+    return last_pose_->second;
+  }
+
   // negative or 0 for tf_max_tries means we spin forever if the transform isn't present
   const std::optional<size_t> max_tries =
       config.tf_max_tries > 0 ? std::optional<size_t>(config.tf_max_tries)
@@ -97,6 +197,10 @@ PoseStatus RosInputModule::getBodyPose(uint64_t timestamp_ns) {
     have_first_pose_ = true;
   }
 
+  if (pose_status && batch) {
+    last_pose_ = std::make_pair(*batch, pose_status);
+  }
+
   if (!pose_status && !have_first_pose_ && config.clear_queue_on_fail) {
     LOG(WARNING) << "Clearing input queues while pose is unavailable";
     for (auto& receiver : receivers_) {
@@ -41,12 +41,11 @@
 #include <config_utilities/validation.h>
 #include <glog/logging.h>
 #include <hydra/common/global_info.h>
-#include <rosbag/bag.h>
-#include <rosbag/view.h>
 #include <sensor_msgs/CameraInfo.h>
 
-#include "hydra_ros/utils/lookup_tf.h"
-#include "hydra_ros/utils/pose_cache.h"
+#include "hydra_ros/utils/camera_info_prefetcher.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/static_tf_cache.h"
 
 namespace hydra {
 
@@ -54,13 +53,8 @@ using config::internal::ConfigFactory;
 using config::internal::ModuleMapBase;
 using config::internal::typeInfo;
 
-struct CameraInfoFunctor {
-  void callback(const sensor_msgs::CameraInfo::ConstPtr& info) { msg = info; }
-
-  sensor_msgs::CameraInfo::ConstPtr msg;
-};
-
 void fillConfigFromInfo(const sensor_msgs::CameraInfo& msg,
+                        const ImageDecimator::Config& decimation,
                         Camera::Config& cam_config) {
   cam_config.width = msg.width;
   cam_config.height = msg.height;
@@ -68,13 +62,24 @@ void fillConfigFromInfo(const sensor_msgs::CameraInfo& msg,
   cam_config.fy = msg.K[4];
   cam_config.cx = msg.K[2];
   cam_config.cy = msg.K[5];
+  ImageDecimator(decimation).scaleIntrinsics(cam_config);
 }
 
 RosSensorExtrinsics::RosSensorExtrinsics(const RosSensorExtrinsics::Config& config)
     : SensorExtrinsics() {
   config::checkValid(config);
+  // every sensor frame is looked up at once and counts against the same startup budget
+  // as the camera info
+  const auto& robot = GlobalInfo::instance().getFrames().robot;
+  auto& prefetcher = CameraInfoPrefetcher::instance();
+  prefetcher.prefetchExtrinsics(
+      robot, findSensorFrames(getNodeHandle("~")), config.timeout_s);
   const auto pose_status =
-      lookupTransform(GlobalInfo::instance().getFrames().robot, config.sensor_frame);
+      prefetcher.waitExtrinsics(robot, config.sensor_frame, config.timeout_s);
+  if (!pose_status.is_valid && !keepWaiting()) {
+    throw InitInterrupted("stopped looking up extrinsics for " + config.sensor_frame);
+  }
+
   CHECK(pose_status.is_valid) << "Could not look up extrinsics from ros!";
   body_R_sensor = pose_status.target_R_source;
   body_p_sensor = pose_status.target_p_source;
@@ -87,12 +92,8 @@ RosSensorExtrinsics::RosSensorExtrinsics(const RosSensorExtrinsics::Config& conf
 RosbagExtrinsics::RosbagExtrinsics(const RosbagExtrinsics::Config& config)
     : SensorExtrinsics() {
   config::checkValid(config);
-  PoseCache::Config cache_config;
-  cache_config.bag_path = config.bag_path;
-  cache_config.static_only = true;
-  PoseCache cache(cache_config);
-
-  const auto pose_status = cache.lookupPose(
+  const auto bag = StaticTfCache::instance().loadBag(config.bag_path);
+  const auto pose_status = bag->poses.lookupPose(
       0, GlobalInfo::instance().getFrames().robot, config.sensor_frame);
   CHECK(pose_status) << "Could not look up extrinsics from bag!";
   body_R_sensor = pose_status.to_R_from;
@@ -125,36 +126,41 @@ RosIntrinsicsRegistration::RosIntrinsicsRegistration(const std::string& name) {
 
 Camera::Config RosCameraIntrinsics::makeCameraConfig(const YAML::Node& data,
                                                      const Config& config) {
+  ros::NodeHandle nh = getNodeHandle("~");
+  const auto resolved_topic = nh.resolveName(config.topic);
+
   sensor_msgs::CameraInfo::ConstPtr msg;
+  if (config.use_cached && !config.cache_path.empty()) {
+    msg = readCachedCameraInfo(config.cache_path, resolved_topic);
+    LOG_IF(INFO, msg) << "Using cached CameraInfo for " << resolved_topic << " from "
+                      << config.cache_path;
+  }
 
-  ros::NodeHandle nh("~");
-  const auto resolved_topic = nh.resolveName(config.topic);
-  CameraInfoFunctor functor;
-  ros::Subscriber sub =
-      nh.subscribe(config.topic, 1, &CameraInfoFunctor::callback, &functor);
-
-  // LOG(INFO) << "test_print_config" << std::endl << config::toString(config);
-
-  LOG(INFO) << "Waiting for CameraInfo on " << resolved_topic
-            << " to initialize sensor model";
-  ros::WallRate r(10);
-  while (ros::ok()) {
-    if (functor.msg) {
-      break;
+  if (!msg) {
+    // requests every configured camera at once so that waiting for this one overlaps
+    // with the rest
+    auto& prefetcher = CameraInfoPrefetcher::instance();
+    prefetcher.prefetch(nh, findCameraInfoTopics(nh), config.timeout_s);
+    // extrinsics are looked up next, so resolve them while waiting as well
+    prefetcher.prefetchExtrinsics(GlobalInfo::instance().getFrames().robot,
+                                  findSensorFrames(nh),
+                                  config.timeout_s);
+    msg = prefetcher.wait(nh, config.topic, config.timeout_s);
+    if (msg && !config.cache_path.empty()) {
+      writeCachedCameraInfo(config.cache_path, resolved_topic, *msg);
     }
-
-    ros::spinOnce();
-    r.sleep();
   }
 
-  if (!functor.msg) {
-    LOG(ERROR) << "did not receive message on " << resolved_topic;
-    return {};
+  if (!msg && !keepWaiting()) {
+    throw InitInterrupted("stopped waiting for camera info on " + resolved_topic);
   }
 
+  // a camera with zero intrinsics silently breaks reconstruction
+  CHECK(msg) << "did not receive message on " << resolved_topic;
+
   Camera::Config cam_config;
   config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config), data);
-  fillConfigFromInfo(*functor.msg, cam_config);
+  fillConfigFromInfo(*msg, config.decimation, cam_config);
   LOG(INFO) << "Initialized camera as " << std::endl << config::toString(cam_config);
   return cam_config;
 }
@@ -162,35 +168,22 @@ Camera::Config RosCameraIntrinsics::makeCameraConfig(const YAML::Node& data,
 Camera::Config RosbagCameraIntrinsics::makeCameraConfig(const YAML::Node& data,
                                                         const Config& config) {
   LOG(INFO) << "Loading camera intrinsics from " << config.bag_path;
+  const auto bag = StaticTfCache::instance().loadBag(config.bag_path);
 
-  rosbag::Bag bag;
-  bag.open(config.bag_path, rosbag::bagmode::Read);
-  rosbag::View view(bag, rosbag::TopicQuery(std::vector<std::string>{config.topic}));
-
-  Camera::Config cam_config;
-  for (const auto& m : view) {
-    const auto msg = m.instantiate<sensor_msgs::CameraInfo>();
-    if (!msg) {
-      LOG(ERROR) << "Topic '" << config.topic << "' is invalid!";
-      break;
-    }
-
-    config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config),
-                                         data);
-    cam_config.width = msg->width;
-    cam_config.height = msg->height;
-    cam_config.cx = msg->K[2];
-    cam_config.cy = msg->K[5];
-    cam_config.fx = msg->K[0];
-    cam_config.fy = msg->K[4];
-    LOG(INFO) << "Initialized Camera Info as " << std::endl
-              << config::toString(cam_config);
-    return cam_config;
+  // bag topics are always fully qualified
+  auto iter = bag->camera_info.find(config.topic);
+  if (iter == bag->camera_info.end()) {
+    iter = bag->camera_info.find("/" + config.topic);
   }
 
-  bag.close();
+  CHECK(iter != bag->camera_info.end())
+      << "Failed to find topic '" << config.topic << "' in bag!'";
 
-  LOG(ERROR) << "Failed to find topic '" << config.topic << "' in bag!'";
+  Camera::Config cam_config;
+  config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config), data);
+  fillConfigFromInfo(*iter->second, config.decimation, cam_config);
+  LOG(INFO) << "Initialized Camera Info as " << std::endl
+            << config::toString(cam_config);
   return cam_config;
 }
 
@@ -198,6 +191,7 @@ void declare_config(RosSensorExtrinsics::Config& conf) {
   using namespace config;
   name("RosSensorExtrinsics::Config");
   field(conf.sensor_frame, "sensor_frame");
+  field(conf.timeout_s, "timeout_s");
   checkCondition(!conf.sensor_frame.empty(), "sensor frame required");
 }
 
@@ -215,6 +209,10 @@ void declare_config(RosCameraIntrinsics::Config& conf) {
   name("RosCameraIntrinsics::Config");
   base<Sensor::Config>(conf);
   field(conf.topic, "camera_info_topic");
+  field(conf.decimation, "decimation");
+  field(conf.timeout_s, "timeout_s");
+  field(conf.cache_path, "cache_path");
+  field(conf.use_cached, "use_cached");
   checkCondition(!conf.topic.empty(), "camera info topic required");
 }
 
@@ -224,6 +222,7 @@ void declare_config(RosbagCameraIntrinsics::Config& config) {
   base<Sensor::Config>(config);
   field(config.topic, "camera_info_topic");
   field<Path>(config.bag_path, "bag_path");
+  field(config.decimation, "decimation");
   checkCondition(!config.topic.empty(), "camera info topic required");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
@@ -0,0 +1,150 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/tf_packet_gate.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace hydra {
+
+TfPacketGate::TfPacketGate(tf2::BufferCore& buffer,
+                           const std::string& target,
+                           const std::string& source,
+                           double max_deferral_s)
+    : buffer_(buffer),
+      target_(target),
+      source_(source),
+      max_deferral_ns_(static_cast<uint64_t>(std::max(max_deferral_s, 0.0) * 1.0e9)),
+      active_(true),
+      newest_ns_(0),
+      num_dropped_(0) {
+  connection_ = buffer_._addTransformsChangedListener([this]() { release(); });
+}
+
+TfPacketGate::~TfPacketGate() { shutdown(); }
+
+void TfPacketGate::submit(const InputPacket::Ptr& packet, const Sink& sink) {
+  if (!packet) {
+    return;
+  }
+
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active_ && !transformAvailable(packet->timestamp_ns)) {
+      VLOG(5) << "[TfPacketGate] deferring packet @ " << packet->timestamp_ns
+              << " [ns] until " << target_ << "_T_" << source_ << " is available";
+      newest_ns_ = std::max(newest_ns_, packet->timestamp_ns);
+      pending_.emplace(packet->timestamp_ns, Pending{packet, sink});
+      dropExpired();
+      return;
+    }
+
+    newest_ns_ = std::max(newest_ns_, packet->timestamp_ns);
+    dropExpired();
+  }
+
+  sink(packet);
+}
+
+void TfPacketGate::release() {
+  std::vector<Pending> ready;
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = pending_.begin();
+    while (iter != pending_.end()) {
+      if (!transformAvailable(iter->first)) {
+        ++iter;
+        continue;
+      }
+
+      ready.push_back(std::move(iter->second));
+      iter = pending_.erase(iter);
+    }
+  }
+
+  // pending packets are visited in time order, so each sink sees them in order
+  for (const auto& entry : ready) {
+    VLOG(5) << "[TfPacketGate] releasing packet @ " << entry.packet->timestamp_ns
+            << " [ns]";
+    entry.sink(entry.packet);
+  }
+}
+
+void TfPacketGate::shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!active_) {
+    return;
+  }
+
+  active_ = false;
+  buffer_._removeTransformsChangedListener(connection_);
+  pending_.clear();
+}
+
+size_t TfPacketGate::numPending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+size_t TfPacketGate::numDropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_dropped_;
+}
+
+bool TfPacketGate::transformAvailable(uint64_t timestamp_ns) const {
+  ros::Time stamp;
+  stamp.fromNSec(timestamp_ns);
+  return buffer_.canTransform(target_, source_, stamp, nullptr);
+}
+
+void TfPacketGate::dropExpired() {
+  if (newest_ns_ < max_deferral_ns_) {
+    return;
+  }
+
+  const auto oldest_allowed_ns = newest_ns_ - max_deferral_ns_;
+  auto iter = pending_.begin();
+  while (iter != pending_.end() && iter->first < oldest_allowed_ns) {
+    LOG(WARNING) << "[TfPacketGate] dropping packet @ " << iter->first
+                 << " [ns]: no " << target_ << "_T_" << source_ << " within "
+                 << max_deferral_ns_ * 1.0e-9 << " [s]";
+    ++num_dropped_;
+    iter = pending_.erase(iter);
+  }
+}
+
+}  // namespace hydra
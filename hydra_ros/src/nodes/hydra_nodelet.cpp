@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <config_utilities/config_utilities.h>
+#include <config_utilities/formatting/asl.h>
+#include <config_utilities/logging/log_to_glog.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <hydra/common/global_info.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <std_srvs/Empty.h>
+
+#include <mutex>
+#include <thread>
+
+#include "hydra_ros/hydra_ros_pipeline.h"
+#include "hydra_ros/utils/node_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief Runs the Hydra pipeline inside a nodelet manager
+ *
+ * Loading the pipeline into the same manager as the sensor drivers lets receivers
+ * get messages by pointer instead of over TCPROS. All hydra node handles are resolved
+ * against the nodelet's (multi-threaded) private node handle.
+ */
+class HydraNodelet : public nodelet::Nodelet {
+ public:
+  HydraNodelet() : stopped_(false) {}
+
+  ~HydraNodelet() override {
+    // initialization may be blocked waiting for camera info or tf
+    interruptWaits();
+    if (init_thread_.joinable()) {
+      init_thread_.join();
+    }
+
+    stop(true);
+  }
+
+ private:
+  void onInit() override {
+    ros::NodeHandle nh = getMTPrivateNodeHandle();
+    setPrivateNodeHandle(nh);
+
+    // glog flags are passed as nodelet arguments
+    const auto args = getMyArgv();
+    std::vector<char*> argv{const_cast<char*>("hydra_nodelet")};
+    for (const auto& arg : args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+
+    int argc = argv.size();
+    char** argv_ptr = argv.data();
+    google::ParseCommandLineFlags(&argc, &argv_ptr, false);
+    if (!google::IsGoogleLoggingInitialized()) {
+      google::InitGoogleLogging("hydra_nodelet");
+    }
+
+    config::Settings().setLogger("glog");
+    config::Settings().print_width = 100;
+    config::Settings().print_indent = 45;
+    interruptWaits(false);
+
+    shutdown_service_ =
+        nh.advertiseService("shutdown", &HydraNodelet::shutdownCallback, this);
+    // initializing the pipeline blocks until sensor information is available, which
+    // would stall the nodelet manager if done in onInit
+    init_thread_ = std::thread(&HydraNodelet::start, this, nh);
+  }
+
+  void start(ros::NodeHandle nh) {
+    const int robot_id = nh.param<int>("robot_id", 0);
+    auto pipeline = std::make_unique<HydraRosPipeline>(nh, robot_id);
+    try {
+      pipeline->init();
+    } catch (const InitInterrupted& e) {
+      LOG(WARNING) << "Hydra nodelet initialization interrupted: " << e.what();
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      LOG(WARNING) << "Hydra nodelet stopped during initialization";
+      return;
+    }
+
+    pipeline->start();
+    pipeline_ = std::move(pipeline);
+    NODELET_INFO("Hydra pipeline started");
+  }
+
+  void stop(bool save) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+
+    stopped_ = true;
+    if (!pipeline_) {
+      return;
+    }
+
+    pipeline_->stop();
+    if (save) {
+      pipeline_->save();
+    }
+
+    pipeline_.reset();
+    GlobalInfo::exit();
+  }
+
+  bool shutdownCallback(std_srvs::Empty::Request&, std_srvs::Empty::Response&) {
+    NODELET_WARN("Stopping hydra pipeline");
+    stop(true);
+    return true;
+  }
+
+  std::mutex mutex_;
+  bool stopped_;
+  std::thread init_thread_;
+  std::unique_ptr<HydraRosPipeline> pipeline_;
+  ros::ServiceServer shutdown_service_;
+};
+
+}  // namespace hydra
+
+PLUGINLIB_EXPORT_CLASS(hydra::HydraNodelet, nodelet::Nodelet)
@@ -52,6 +52,8 @@
 #include <glog/logging.h>
 #include <pose_graph_tools_ros/conversions.h>
 
+#include "hydra_ros/utils/node_utilities.h"
+
 namespace hydra {
 
 using PoseGraphMsg = pose_graph_tools_msgs::PoseGraph;
@@ -64,7 +66,7 @@ void declare_config(RosPoseGraphTracker::Config& config) {
 }
 
 RosPoseGraphTracker::RosPoseGraphTracker(const Config& config)
-    : config(config::checkValid(config)), nh_(config.ns) {
+    : config(config::checkValid(config)), nh_(getNodeHandle(config.ns)) {
   odom_sub_ = nh_.subscribe(
       "pose_graph", config.queue_size, &RosPoseGraphTracker::odomCallback, this);
   prior_sub_ = nh_.subscribe("agent_node_measurements",
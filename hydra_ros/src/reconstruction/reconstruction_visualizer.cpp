@@ -40,6 +40,7 @@
 #include <hydra/common/global_info.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include "hydra_ros/utils/node_utilities.h"
 #include "hydra_ros/visualizer/colormap_utilities.h"
 #include "hydra_ros/visualizer/gvd_visualization_utilities.h"
 
@@ -148,7 +149,7 @@ void declare_config(ReconstructionVisualizer::Config& config) {
 }
 
 ReconstructionVisualizer::ReconstructionVisualizer(const Config& config)
-    : config_(config), nh_(config.ns) {
+    : config_(config), nh_(getNodeHandle(config.ns)) {
   pubs_.reset(new MarkerGroupPub(nh_));
 }
 
@@ -46,17 +46,35 @@
 #include <hydra/input/input_packet.h>
 #include <hydra/input/input_conversion.h>
 #include <message_filters/sync_policies/approximate_time.h>
+#include <ros/message_traits.h>
 #include <rosbag/bag.h>
 #include <rosbag/view.h>
 #include <sensor_msgs/CameraInfo.h>
 #include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/image_encodings.h>
 
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <iomanip>
+
+#include "hydra_ros/utils/compressed_image.h"
 #include "hydra_ros/utils/pose_cache.h"
+#include "hydra_ros/utils/shared_image.h"
+
+namespace ros::message_traits {
+
+// lets message_filters synchronize decoded images
+template <>
+struct TimeStamp<hydra::BagImage> {
+  static ros::Time value(const hydra::BagImage& msg) { return msg.header.stamp; }
+};
+
+}  // namespace ros::message_traits
 
 namespace hydra {
 
 using sensor_msgs::Image;
-using Policy = message_filters::sync_policies::ApproximateTime<Image, Image>;
+using Policy = message_filters::sync_policies::ApproximateTime<BagImage, BagImage>;
 using TimeSync = message_filters::Synchronizer<Policy>;
 
 void declare_config(BagConfig& config) {
@@ -67,7 +85,9 @@ void declare_config(BagConfig& config) {
   field(config.depth_topic, "depth_topic");
   field(config.start, "start");
   field(config.duration, "duration");
+  field(config.color_compressed, "color_compressed");
   field(config.sensor, "sensor");
+  field(config.decimation, "decimation");
   field(config.sensor_frame, "sensor_frame");
   field(config.world_frame, "world_frame");
   check(config.color_topic, NE, "", "color_topic");
@@ -75,21 +95,28 @@ void declare_config(BagConfig& config) {
   check<Path::Exists>(config.bag_path, "bag_path");
 }
 
-sensor_msgs::Image::ConstPtr getImageMessage(const rosbag::MessageInstance& m) {
-  const auto raw = m.instantiate<sensor_msgs::Image>();
-  if (raw) {
-    // no need to do anything special with normal image
-    return raw;
-  }
-
-  auto msg = m.instantiate<sensor_msgs::CompressedImage>();
-  if (!msg) {
-    LOG(ERROR) << "Unable to parse image from '" << m.getTopic() << "'";
+BagImage::ConstPtr viewBagImage(const Image::ConstPtr& msg, bool is_color) {
+  auto image = boost::make_shared<BagImage>();
+  image->header = msg->header;
+  try {
+    // only copies if the color image is not already RGB
+    image->image = viewImage(msg, is_color ? sensor_msgs::image_encodings::RGB8 : "")
+                       .image;
+  } catch (const cv_bridge::Exception& e) {
+    LOG(ERROR) << "Unable to read image @ " << msg->header.stamp.toNSec()
+               << " [ns]: " << e.what();
     return nullptr;
   }
 
-  const auto cv_ptr = cv_bridge::toCvCopy(msg);
-  return cv_ptr->toImageMsg();
+  return image;
+}
+
+BagImage::ConstPtr decodeBagImage(const sensor_msgs::CompressedImage& msg,
+                                  bool is_color) {
+  auto image = boost::make_shared<BagImage>();
+  image->header = msg.header;
+  image->image = decodeCompressedImage(msg, is_color);
+  return image->image.empty() ? nullptr : image;
 }
 
 BagReader::BagReader(const Config& config)
@@ -112,13 +139,32 @@ struct Trampoline {
   BagReader* reader;
   const PoseCache* cache;
   Sensor::ConstPtr sensor;
+  DecodeStage* processing;
+
+  void call(const BagImage::ConstPtr& msg1, const BagImage::ConstPtr& msg2) {
+    // pose lookup and normalization run in parallel, sinks are called in order
+    processing->submit(msg1->header.stamp.toNSec(), [this, msg1, msg2]() {
+      const auto data = reader->makeInputData(config, sensor, *cache, msg1, msg2);
+      if (!data) {
+        return DecodeStage::Continuation();
+      }
 
-  void call(const sensor_msgs::Image::ConstPtr& msg1,
-            const sensor_msgs::Image::ConstPtr& msg2) {
-    reader->handleImages(config, sensor, *cache, msg1, msg2);
+      return DecodeStage::Continuation(
+          [this, data]() { Sink::callAll(reader->sinks_, *data); });
+    });
   }
 };
 
+namespace {
+
+void logStage(const std::string& name, size_t count, double busy_s, double wall_s) {
+  LOG(INFO) << "  " << std::left << std::setw(12) << name << count << " items, "
+            << busy_s << " [s] busy, "
+            << (wall_s > 0.0 ? count / wall_s : 0.0) << " items/s";
+}
+
+}  // namespace
+
 void BagReader::readBag(const BagConfig& bag_config) {
   LOG(INFO) << "Reading bag from config: " << std::endl << config::toString(bag_config);
   std::vector<std::string> topics{bag_config.color_topic, bag_config.depth_topic};
@@ -133,14 +179,29 @@ void BagReader::readBag(const BagConfig& bag_config) {
   }
 
   PoseCache cache(bag);
-  Trampoline trampoline{bag_config, this, &cache, sensor};
+  // stages are destroyed (and therefore flushed) in reverse order
+  DecodeStage processing(config.processing);
+  Trampoline trampoline{bag_config, this, &cache, sensor, &processing};
 
   TimeSync sync(Policy(10));
   sync.registerCallback(&Trampoline::call, &trampoline);
+  StampJoin<BagImage::ConstPtr> join(
+      config.stamp_join,
+      [&trampoline](const BagImage::ConstPtr& color, const BagImage::ConstPtr& depth) {
+        trampoline.call(color, depth);
+      });
+
+  // decodes images in parallel and feeds them to the synchronizer in order
+  DecodeStage decoder(config.decoding);
+
+  const auto start_time = std::chrono::steady_clock::now();
+  double read_s = 0.0;
+  size_t num_read = 0;
 
   ros::Time start;
   bool have_start = false;
   rosbag::View view(bag, rosbag::TopicQuery(topics));
+  auto read_start = std::chrono::steady_clock::now();
   for (const auto& m : view) {
     if (!have_start) {
       start = m.getTime();
@@ -158,27 +219,78 @@ void BagReader::readBag(const BagConfig& bag_config) {
 
     if (bag_config.duration >= 0.0 && diff_s > bag_config.duration) {
       LOG(INFO) << "Reached end of duration: " << diff_s << " [s]";
-      return;
+      break;
     }
 
-    const auto topic = m.getTopic();
-    auto msg = getImageMessage(m);
-    if (!msg) {
+    // messages are read from the bag on this thread and only decoded in parallel
+    const bool is_color = m.getTopic() == bag_config.color_topic;
+    const bool try_raw = !is_color || !bag_config.color_compressed;
+    const auto raw = try_raw ? m.instantiate<Image>() : nullptr;
+    const auto compressed =
+        raw ? nullptr : m.instantiate<sensor_msgs::CompressedImage>();
+    if (!raw && !compressed) {
+      LOG(ERROR) << "Unable to parse image from '" << m.getTopic() << "'";
       continue;
     }
 
-    if (topic == bag_config.color_topic) {
-      VLOG(10) << "new " << bag_config.color_topic << " @ "
-               << msg->header.stamp.toNSec();
-      sync.add<0>(ros::MessageEvent<Image>(msg, m.getTime()));
-    } else {
-      VLOG(10) << "new " << bag_config.depth_topic << " @ "
-               << msg->header.stamp.toNSec();
-      sync.add<1>(ros::MessageEvent<Image>(msg, m.getTime()));
-    }
+    const auto receipt_time = m.getTime();
+    const auto stamp = raw ? raw->header.stamp : compressed->header.stamp;
+    const std::chrono::duration<double> read_elapsed =
+        std::chrono::steady_clock::now() - read_start;
+    read_s += read_elapsed.count();
+    ++num_read;
+
+    decoder.submit(stamp.toNSec(), [&, raw, compressed, is_color, receipt_time]() {
+      const auto msg =
+          raw ? viewBagImage(raw, is_color) : decodeBagImage(*compressed, is_color);
+      if (!msg) {
+        return DecodeStage::Continuation();
+      }
+
+      return DecodeStage::Continuation([&, msg, is_color, receipt_time]() {
+        if (config.use_stamp_join) {
+          join.add(is_color ? 0 : 1, msg->header.stamp.toNSec(), msg);
+        } else if (is_color) {
+          VLOG(10) << "new " << bag_config.color_topic << " @ "
+                   << msg->header.stamp.toNSec();
+          sync.add<0>(ros::MessageEvent<const BagImage>(msg, receipt_time));
+        } else {
+          VLOG(10) << "new " << bag_config.depth_topic << " @ "
+                   << msg->header.stamp.toNSec();
+          sync.add<1>(ros::MessageEvent<const BagImage>(msg, receipt_time));
+        }
+      });
+    });
+
+    read_start = std::chrono::steady_clock::now();
   }
 
+  decoder.flush();
+  join.flush();
+  processing.flush();
   bag.close();
+
+  const std::chrono::duration<double> wall =
+      std::chrono::steady_clock::now() - start_time;
+  const auto decode_stats = decoder.stats();
+  const auto processing_stats = processing.stats();
+  LOG(INFO) << "Finished " << bag_config.bag_path << " in " << wall.count() << " [s]:";
+  logStage("read", num_read, read_s, wall.count());
+  logStage("decode", decode_stats.num_tasks, decode_stats.task_s, wall.count());
+  logStage("process",
+           processing_stats.num_tasks,
+           processing_stats.task_s,
+           wall.count());
+  logStage("sinks",
+           processing_stats.num_delivered,
+           processing_stats.delivery_s,
+           wall.count());
+  if (config.use_stamp_join) {
+    const auto& join_stats = join.stats();
+    LOG(INFO) << "Paired " << join_stats.num_matched << " frames ("
+              << join_stats.num_unmatched[0] << " color and "
+              << join_stats.num_unmatched[1] << " depth images unmatched)";
+  }
 }
 
 void BagReader::handleImages(const BagConfig& bag_config,
@@ -186,45 +298,65 @@ void BagReader::handleImages(const BagConfig& bag_config,
                              const PoseCache& cache,
                              const sensor_msgs::Image::ConstPtr& color_msg,
                              const sensor_msgs::Image::ConstPtr& depth_msg) {
+  const auto color = viewBagImage(color_msg, true);
+  const auto depth = viewBagImage(depth_msg, false);
+  if (!color || !depth) {
+    return;
+  }
+
+  const auto data = makeInputData(bag_config, sensor, cache, color, depth);
+  if (data) {
+    Sink::callAll(sinks_, *data);
+  }
+}
+
+std::shared_ptr<InputData> BagReader::makeInputData(
+    const BagConfig& bag_config,
+    const Sensor::ConstPtr& sensor,
+    const PoseCache& cache,
+    const BagImage::ConstPtr& color,
+    const BagImage::ConstPtr& depth) const {
   if (!sensor) {
     LOG(ERROR) << "sensor required!";
-    return;
+    return nullptr;
   }
 
-  const auto timestamp_ns = color_msg->header.stamp.toNSec();
+  const auto timestamp_ns = color->header.stamp.toNSec();
   VLOG(5) << "processing images @ " << timestamp_ns << " [ns]";
 
   const auto sensor_frame = !bag_config.sensor_frame.empty()
                                 ? bag_config.sensor_frame
-                                : color_msg->header.frame_id;
+                                : color->header.frame_id;
   const auto world_frame = !bag_config.world_frame.empty()
                                ? bag_config.world_frame
                                : GlobalInfo::instance().getFrames().odom;
   const auto pose = cache.lookupPose(timestamp_ns, world_frame, sensor_frame);
   if (!pose) {
     LOG(ERROR) << "Could not find pose for data @ " << timestamp_ns << " [ns]";
-    return;
+    return nullptr;
   }
 
-  InputData data(sensor);
-  data.timestamp_ns = timestamp_ns;
-  data.world_T_body = pose.to_T_from();
-  data.color_image = cv_bridge::toCvCopy(color_msg)->image.clone();
-  cv::cvtColor(data.color_image, data.color_image, cv::COLOR_BGR2RGB);
-  data.depth_image = cv_bridge::toCvCopy(depth_msg)->image.clone();
+  auto data = std::make_shared<InputData>(sensor);
+  data->timestamp_ns = timestamp_ns;
+  data->world_T_body = pose.to_T_from();
+  // images are already in the layout the sensor expects and are only copied when
+  // decimated
+  const ImageDecimator decimator(bag_config.decimation);
+  data->color_image = decimator.nearest(color->image);
+  data->depth_image = decimator.depth(depth->image);
 
-  const auto valid = conversions::normalizeData(data, false);
+  const auto valid = conversions::normalizeData(*data, false);
   if (!valid) {
-    LOG(ERROR) << "Failed to normalize frame data @ " << data.timestamp_ns << " [ns]";
-    return;
+    LOG(ERROR) << "Failed to normalize frame data @ " << data->timestamp_ns << " [ns]";
+    return nullptr;
   }
 
-  if (!sensor->finalizeRepresentations(data)) {
-    LOG(ERROR) << "Failed to finalized data @ " << data.timestamp_ns << " [ns]";
-    return;
+  if (!sensor->finalizeRepresentations(*data)) {
+    LOG(ERROR) << "Failed to finalized data @ " << data->timestamp_ns << " [ns]";
+    return nullptr;
   }
 
-  Sink::callAll(sinks_, data);
+  return data;
 }
 
 void declare_config(BagReader::Config& config) {
@@ -232,6 +364,10 @@ void declare_config(BagReader::Config& config) {
   name("BagReader::Config");
   field(config.bags, "bags");
   field(config.sinks, "sinks");
+  field(config.decoding, "decoding");
+  field(config.processing, "processing");
+  field(config.use_stamp_join, "use_stamp_join");
+  field(config.stamp_join, "stamp_join");
 }
 
 }  // namespace hydra
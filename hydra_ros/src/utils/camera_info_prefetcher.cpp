@@ -0,0 +1,328 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/camera_info_prefetcher.h"
+
+#include <glog/logging.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <fstream>
+
+#include "hydra_ros/utils/lookup_tf.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/static_tf_cache.h"
+
+namespace hydra {
+
+using sensor_msgs::CameraInfo;
+
+CameraInfoPrefetcher& CameraInfoPrefetcher::instance() {
+  static CameraInfoPrefetcher prefetcher;
+  return prefetcher;
+}
+
+CameraInfoPrefetcher::~CameraInfoPrefetcher() { reset(); }
+
+void CameraInfoPrefetcher::prefetch(const ros::NodeHandle& nh,
+                                    const std::vector<std::string>& topics,
+                                    double timeout_s) {
+  startTimer(timeout_s);
+  for (const auto& topic : topics) {
+    request(nh, topic);
+  }
+}
+
+CameraInfo::ConstPtr CameraInfoPrefetcher::wait(const ros::NodeHandle& nh,
+                                                const std::string& topic,
+                                                double timeout_s) {
+  const auto deadline = startTimer(timeout_s);
+  const auto result = request(nh, topic)->result;
+
+  // polls so that waiting stops when ros shuts down or waits are interrupted
+  const auto poll_period = std::chrono::milliseconds(100);
+  while (keepWaiting()) {
+    if (result.wait_for(poll_period) == std::future_status::ready) {
+      return result.get();
+    }
+
+    if (deadline && Clock::now() >= *deadline) {
+      break;
+    }
+  }
+
+  return nullptr;
+}
+
+void CameraInfoPrefetcher::prefetchExtrinsics(const std::string& target,
+                                              const std::vector<std::string>& frames,
+                                              double timeout_s) {
+  startTimer(timeout_s);
+  for (const auto& frame : frames) {
+    requestExtrinsics(target, frame);
+  }
+}
+
+PoseStatus CameraInfoPrefetcher::waitExtrinsics(const std::string& target,
+                                                const std::string& frame,
+                                                double timeout_s) {
+  startTimer(timeout_s);
+  // the lookup itself stops at the deadline or when waits are interrupted
+  return requestExtrinsics(target, frame).get();
+}
+
+void CameraInfoPrefetcher::reset() {
+  std::unique_ptr<ros::AsyncSpinner> spinner;
+  std::map<std::string, std::shared_ptr<Request>> requests;
+  std::map<FrameKey, std::shared_future<PoseStatus>> extrinsics;
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    spinner.swap(spinner_);
+    requests.swap(requests_);
+    extrinsics.swap(extrinsics_);
+    deadline_.reset();
+  }
+
+  for (const auto& [key, result] : extrinsics) {
+    result.wait();
+  }
+
+  if (spinner) {
+    spinner->stop();
+  }
+
+  for (auto& [topic, request] : requests) {
+    request->sub.shutdown();
+  }
+
+  queue_.clear();
+}
+
+std::shared_ptr<CameraInfoPrefetcher::Request> CameraInfoPrefetcher::request(
+    const ros::NodeHandle& nh, const std::string& topic) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto resolved = nh.resolveName(topic);
+  auto iter = requests_.find(resolved);
+  if (iter != requests_.end()) {
+    return iter->second;
+  }
+
+  auto request = std::make_shared<Request>();
+  request->result = request->promise.get_future().share();
+  ros::NodeHandle queue_nh(nh);
+  queue_nh.setCallbackQueue(&queue_);
+  std::weak_ptr<Request> weak_request = request;
+  const boost::function<void(const CameraInfo::ConstPtr&)> callback =
+      [weak_request](const CameraInfo::ConstPtr& msg) {
+        auto request = weak_request.lock();
+        if (request) {
+          // only the first message is kept
+          std::call_once(request->received,
+                         [&request, &msg]() { request->promise.set_value(msg); });
+        }
+      };
+  request->sub = queue_nh.subscribe<CameraInfo>(topic, 1, callback);
+
+  LOG(INFO) << "Waiting for CameraInfo on " << resolved;
+  requests_.emplace(resolved, request);
+  if (!spinner_) {
+    spinner_ = std::make_unique<ros::AsyncSpinner>(1, &queue_);
+    spinner_->start();
+  }
+
+  return request;
+}
+
+std::shared_future<PoseStatus> CameraInfoPrefetcher::requestExtrinsics(
+    const std::string& target, const std::string& frame) {
+  // the tf listener has to exist before any lookup starts
+  const auto& buffer = StaticTfCache::instance().liveBuffer();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const FrameKey key(target, frame);
+  auto iter = extrinsics_.find(key);
+  if (iter != extrinsics_.end()) {
+    return iter->second;
+  }
+
+  std::optional<size_t> max_tries;
+  const double wait_duration_s = 0.1;
+  if (deadline_) {
+    const std::chrono::duration<double> remaining = *deadline_ - Clock::now();
+    const auto remaining_s = std::max(remaining.count(), 0.0);
+    max_tries = static_cast<size_t>(remaining_s / wait_duration_s) + 1;
+  }
+
+  LOG(INFO) << "Looking up extrinsics for " << frame << " in " << target;
+  const auto lookup = [&buffer, key, max_tries, wait_duration_s]() {
+    return lookupTransform(
+        buffer, std::nullopt, key.first, key.second, max_tries, wait_duration_s);
+  };
+  auto result = std::async(std::launch::async, lookup).share();
+  extrinsics_.emplace(key, result);
+  return result;
+}
+
+CameraInfoPrefetcher::Deadline CameraInfoPrefetcher::startTimer(double timeout_s) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (deadline_ || timeout_s <= 0.0) {
+    return deadline_;
+  }
+
+  const auto timeout = std::chrono::duration<double>(timeout_s);
+  deadline_ = Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+  return deadline_;
+}
+
+namespace {
+
+// collects the value of the field for every struct with a matching type
+void findFields(XmlRpc::XmlRpcValue& value,
+                const std::string& type,
+                const std::string& field,
+                std::vector<std::string>& values) {
+  if (value.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+    for (int i = 0; i < value.size(); ++i) {
+      findFields(value[i], type, field, values);
+    }
+
+    return;
+  }
+
+  if (value.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+    return;
+  }
+
+  if (value.hasMember("type") && value.hasMember(field) &&
+      value["type"].getType() == XmlRpc::XmlRpcValue::TypeString &&
+      static_cast<std::string>(value["type"]) == type) {
+    values.push_back(static_cast<std::string>(value[field]));
+  }
+
+  for (auto iter = value.begin(); iter != value.end(); ++iter) {
+    findFields(iter->second, type, field, values);
+  }
+}
+
+std::vector<std::string> findParams(const ros::NodeHandle& nh,
+                                    const std::string& type,
+                                    const std::string& field) {
+  std::vector<std::string> values;
+  XmlRpc::XmlRpcValue params;
+  if (!nh.getParam(nh.getNamespace(), params)) {
+    return values;
+  }
+
+  findFields(params, type, field, values);
+  return values;
+}
+
+}  // namespace
+
+std::vector<std::string> findCameraInfoTopics(const ros::NodeHandle& nh) {
+  return findParams(nh, "camera_info", "camera_info_topic");
+}
+
+std::vector<std::string> findSensorFrames(const ros::NodeHandle& nh) {
+  return findParams(nh, "ros", "sensor_frame");
+}
+
+CameraInfo::ConstPtr readCachedCameraInfo(const std::filesystem::path& cache_path,
+                                          const std::string& topic) {
+  if (!std::filesystem::exists(cache_path)) {
+    return nullptr;
+  }
+
+  try {
+    const auto root = YAML::LoadFile(cache_path.string());
+    const auto node = root[topic];
+    if (!node || !node["valid"] || !node["valid"].as<bool>()) {
+      return nullptr;
+    }
+
+    auto msg = boost::make_shared<CameraInfo>();
+    msg->header.frame_id = node["frame_id"].as<std::string>("");
+    msg->width = node["width"].as<uint32_t>();
+    msg->height = node["height"].as<uint32_t>();
+    msg->distortion_model = node["distortion_model"].as<std::string>("");
+    msg->D = node["D"].as<std::vector<double>>(std::vector<double>());
+    const auto K = node["K"].as<std::vector<double>>();
+    if (K.size() != msg->K.size()) {
+      LOG(WARNING) << "Invalid cached intrinsics for " << topic << " in " << cache_path;
+      return nullptr;
+    }
+
+    std::copy(K.begin(), K.end(), msg->K.begin());
+    return msg;
+  } catch (const YAML::Exception& e) {
+    LOG(WARNING) << "Unable to read cached camera info from " << cache_path << ": "
+                 << e.what();
+    return nullptr;
+  }
+}
+
+bool writeCachedCameraInfo(const std::filesystem::path& cache_path,
+                           const std::string& topic,
+                           const CameraInfo& msg) {
+  YAML::Node root;
+  if (std::filesystem::exists(cache_path)) {
+    try {
+      root = YAML::LoadFile(cache_path.string());
+    } catch (const YAML::Exception& e) {
+      LOG(WARNING) << "Overwriting invalid camera info cache " << cache_path;
+    }
+  }
+
+  YAML::Node node;
+  node["valid"] = true;
+  node["frame_id"] = msg.header.frame_id;
+  node["width"] = msg.width;
+  node["height"] = msg.height;
+  node["distortion_model"] = msg.distortion_model;
+  node["D"] = msg.D;
+  node["K"] = std::vector<double>(msg.K.begin(), msg.K.end());
+  root[topic] = node;
+
+  std::ofstream out(cache_path);
+  if (!out.good()) {
+    LOG(WARNING) << "Unable to write camera info cache to " << cache_path;
+    return false;
+  }
+
+  out << root;
+  return true;
+}
+
+}  // namespace hydra
@@ -0,0 +1,205 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/compressed_image.h"
+
+#include <cv_bridge/cv_bridge.h>
+#include <glog/logging.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <cstring>
+#include <limits>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace hydra {
+
+namespace enc = sensor_msgs::image_encodings;
+
+namespace {
+
+// matches the header written by compressed_depth_image_transport
+struct CompressedDepthHeader {
+  int32_t format;
+  float depth_quant_a;
+  float depth_quant_b;
+};
+
+// formats look like "rgb8; jpeg compressed bgr8", starting with the published encoding
+inline std::string sourceEncoding(const std::string& format) {
+  const auto pos = format.find(';');
+  auto encoding = format.substr(0, pos);
+  encoding.erase(0, encoding.find_first_not_of(' '));
+  encoding.erase(encoding.find_last_not_of(' ') + 1);
+  return encoding;
+}
+
+cv::Mat decodeCompressedDepth(const sensor_msgs::CompressedImage& msg) {
+  constexpr size_t header_size = sizeof(CompressedDepthHeader);
+  if (msg.data.size() <= header_size) {
+    LOG(ERROR) << "compressedDepth message too small: " << msg.data.size() << " bytes";
+    return cv::Mat();
+  }
+
+  CompressedDepthHeader header;
+  std::memcpy(&header, msg.data.data(), header_size);
+
+  // wraps the payload without copying it
+  const cv::Mat payload(1,
+                        msg.data.size() - header_size,
+                        CV_8UC1,
+                        const_cast<uint8_t*>(msg.data.data() + header_size));
+  const cv::Mat decoded = cv::imdecode(payload, cv::IMREAD_UNCHANGED);
+  if (decoded.empty() || decoded.type() != CV_16UC1) {
+    LOG(ERROR) << "Unable to decode compressedDepth payload";
+    return cv::Mat();
+  }
+
+  const auto encoding = sourceEncoding(msg.format);
+  if (encoding == enc::TYPE_16UC1 || encoding == enc::MONO16) {
+    return decoded;
+  }
+
+  if (encoding != enc::TYPE_32FC1) {
+    LOG(ERROR) << "Unsupported compressedDepth encoding: '" << encoding << "'";
+    return cv::Mat();
+  }
+
+  // 32FC1 depth is stored as quantized inverse depth
+  cv::Mat depth(decoded.rows, decoded.cols, CV_32FC1);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (int r = 0; r < decoded.rows; ++r) {
+    const auto in = decoded.ptr<uint16_t>(r);
+    auto out = depth.ptr<float>(r);
+    for (int c = 0; c < decoded.cols; ++c) {
+      out[c] = in[c] ? header.depth_quant_a / (in[c] - header.depth_quant_b) : nan;
+    }
+  }
+
+  return depth;
+}
+
+// the published color encoding if the decoded image can be converted to it
+inline std::string colorEncoding(const std::string& format, int channels) {
+  const auto encoding = sourceEncoding(format);
+  if (channels == 3 && (encoding == enc::RGB8 || encoding == enc::BGR8)) {
+    return encoding;
+  }
+
+  if (channels == 4 && (encoding == enc::RGBA8 || encoding == enc::BGRA8)) {
+    return encoding;
+  }
+
+  return "";
+}
+
+inline std::string encodingForImage(const cv::Mat& image, bool is_depth) {
+  switch (image.type()) {
+    case CV_8UC1:
+      return enc::MONO8;
+    case CV_8UC3:
+      return enc::BGR8;
+    case CV_8UC4:
+      return enc::BGRA8;
+    case CV_16UC1:
+      return is_depth ? enc::TYPE_16UC1 : enc::MONO16;
+    case CV_32FC1:
+      return enc::TYPE_32FC1;
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+bool isCompressedDepth(const sensor_msgs::CompressedImage& msg) {
+  return msg.format.find("compressedDepth") != std::string::npos;
+}
+
+cv::Mat decodeCompressedImage(const sensor_msgs::CompressedImage& msg, bool to_rgb) {
+  if (isCompressedDepth(msg)) {
+    return decodeCompressedDepth(msg);
+  }
+
+  const cv::Mat buffer(
+      1, msg.data.size(), CV_8UC1, const_cast<uint8_t*>(msg.data.data()));
+  cv::Mat decoded = cv::imdecode(buffer, cv::IMREAD_UNCHANGED);
+  if (decoded.empty()) {
+    LOG(ERROR) << "Unable to decode compressed image with format '" << msg.format
+               << "'";
+    return decoded;
+  }
+
+  if (to_rgb) {
+    if (decoded.channels() == 3) {
+      cv::cvtColor(decoded, decoded, cv::COLOR_BGR2RGB);
+    } else if (decoded.channels() == 4) {
+      cv::cvtColor(decoded, decoded, cv::COLOR_BGRA2RGB);
+    }
+
+    return decoded;
+  }
+
+  // imdecode always returns BGR(A), while raw images keep the published channel order
+  const auto encoding = colorEncoding(msg.format, decoded.channels());
+  if (encoding == enc::RGB8) {
+    cv::cvtColor(decoded, decoded, cv::COLOR_BGR2RGB);
+  } else if (encoding == enc::RGBA8) {
+    cv::cvtColor(decoded, decoded, cv::COLOR_BGRA2RGBA);
+  }
+
+  return decoded;
+}
+
+sensor_msgs::Image::Ptr decompressImageMessage(
+    const sensor_msgs::CompressedImage& msg) {
+  const auto image = decodeCompressedImage(msg);
+  if (image.empty()) {
+    return nullptr;
+  }
+
+  auto encoding = colorEncoding(msg.format, image.channels());
+  if (encoding.empty()) {
+    encoding = encodingForImage(image, isCompressedDepth(msg));
+  }
+
+  if (encoding.empty()) {
+    LOG(ERROR) << "Unsupported decoded image type: " << image.type();
+    return nullptr;
+  }
+
+  return cv_bridge::CvImage(msg.header, encoding, image).toImageMsg();
+}
+
+}  // namespace hydra
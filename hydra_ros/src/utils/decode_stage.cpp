@@ -0,0 +1,145 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/decode_stage.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+namespace hydra {
+
+void declare_config(DecodeStage::Config& config) {
+  using namespace config;
+  name("DecodeStage::Config");
+  field(config.num_threads, "num_threads");
+  field(config.max_pending, "max_pending");
+  checkCondition(config.num_threads > 0, "num_threads must be positive");
+  checkCondition(config.max_pending > 0, "max_pending must be positive");
+}
+
+DecodeStage::DecodeStage(const Config& config)
+    : config(config::checkValid(config)),
+      num_submitted_(0),
+      delivering_(false),
+      pool_(std::make_unique<WorkerPool>(config.num_threads)) {}
+
+DecodeStage::~DecodeStage() { flush(); }
+
+void DecodeStage::submit(uint64_t timestamp_ns, const Task& task) {
+  Key key;
+  {  // scope for lock
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return pending_.size() < config.max_pending; });
+    key = {timestamp_ns, num_submitted_++};
+    pending_.emplace(key, Result());
+  }
+
+  pool_->submit([this, key, task]() {
+    const auto start = std::chrono::steady_clock::now();
+    Continuation continuation;
+    try {
+      continuation = task();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Decoding failed for data @ " << key.first << " [ns]: " << e.what();
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    {  // scope for lock
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.num_tasks;
+      stats_.task_s += elapsed.count();
+    }
+
+    finish(key, std::move(continuation));
+  });
+}
+
+void DecodeStage::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // results are removed before they are delivered, so wait for delivery to finish too
+  cv_.wait(lock, [this]() { return pending_.empty() && !delivering_; });
+}
+
+size_t DecodeStage::numPending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+DecodeStage::Stats DecodeStage::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void DecodeStage::finish(const Key& key, Continuation&& continuation) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto& result = pending_.at(key);
+  result.done = true;
+  result.continuation = std::move(continuation);
+  if (delivering_) {
+    // the thread currently delivering results will pick this one up
+    return;
+  }
+
+  delivering_ = true;
+  while (!pending_.empty() && pending_.begin()->second.done) {
+    auto next = std::move(pending_.begin()->second.continuation);
+    pending_.erase(pending_.begin());
+    lock.unlock();
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      if (next) {
+        next();
+      }
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Delivering decoded data failed: " << e.what();
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    lock.lock();
+    if (next) {
+      ++stats_.num_delivered;
+      stats_.delivery_s += elapsed.count();
+    }
+
+    cv_.notify_all();
+  }
+
+  delivering_ = false;
+  cv_.notify_all();
+}
+
+}  // namespace hydra
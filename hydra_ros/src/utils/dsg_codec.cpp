@@ -0,0 +1,218 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/dsg_codec.h"
+
+#include <glog/logging.h>
+
+#include <limits>
+
+#ifdef HYDRA_ROS_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HYDRA_ROS_USE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+namespace hydra {
+
+DsgCodec parseDsgCodec(const std::string& name) {
+  if (name == "zstd") {
+    return DsgCodec::ZSTD;
+  }
+
+  if (name == "lz4") {
+    return DsgCodec::LZ4;
+  }
+
+  LOG_IF(WARNING, name != "none") << "Unknown codec '" << name << "', using 'none'";
+  return DsgCodec::NONE;
+}
+
+std::string toString(DsgCodec codec) {
+  switch (codec) {
+    case DsgCodec::ZSTD:
+      return "zstd";
+    case DsgCodec::LZ4:
+      return "lz4";
+    case DsgCodec::NONE:
+    default:
+      return "none";
+  }
+}
+
+bool hasDsgCodec(DsgCodec codec) {
+  switch (codec) {
+    case DsgCodec::NONE:
+      return true;
+    case DsgCodec::ZSTD:
+#ifdef HYDRA_ROS_USE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    case DsgCodec::LZ4:
+#ifdef HYDRA_ROS_USE_LZ4
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return false;
+  }
+}
+
+int defaultDsgCompressionLevel(DsgCodec codec) {
+  switch (codec) {
+    case DsgCodec::ZSTD:
+      return 3;
+    case DsgCodec::LZ4:
+    case DsgCodec::NONE:
+    default:
+      return 1;
+  }
+}
+
+bool compressDsg(DsgCodec codec,
+                 int level,
+                 const std::vector<uint8_t>& input,
+                 std::vector<uint8_t>& output) {
+  switch (codec) {
+#ifdef HYDRA_ROS_USE_ZSTD
+    case DsgCodec::ZSTD: {
+      output.resize(ZSTD_compressBound(input.size()));
+      const auto size = ZSTD_compress(
+          output.data(), output.size(), input.data(), input.size(), level);
+      if (ZSTD_isError(size)) {
+        LOG(ERROR) << "zstd compression failed: " << ZSTD_getErrorName(size);
+        return false;
+      }
+
+      output.resize(size);
+      return true;
+    }
+#endif
+#ifdef HYDRA_ROS_USE_LZ4
+    case DsgCodec::LZ4: {
+      if (input.size() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        LOG(ERROR) << "Payload too large for lz4: " << input.size() << " bytes";
+        return false;
+      }
+
+      const int input_size = input.size();
+      output.resize(LZ4_compressBound(input_size));
+      const auto src = reinterpret_cast<const char*>(input.data());
+      auto dst = reinterpret_cast<char*>(output.data());
+      const int size =
+          level > 1 ? LZ4_compress_HC(src, dst, input_size, output.size(), level)
+                    : LZ4_compress_default(src, dst, input_size, output.size());
+      if (size <= 0) {
+        LOG(ERROR) << "lz4 compression failed";
+        return false;
+      }
+
+      output.resize(size);
+      return true;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+bool decompressDsg(DsgCodec codec,
+                   const std::vector<uint8_t>& input,
+                   size_t uncompressed_size,
+                   std::vector<uint8_t>& output) {
+  if (codec != DsgCodec::NONE && uncompressed_size > kMaxDsgPayloadSize) {
+    LOG(ERROR) << "Rejecting dsg payload of " << uncompressed_size
+               << " bytes (limit: " << kMaxDsgPayloadSize << ")";
+    return false;
+  }
+
+  switch (codec) {
+    case DsgCodec::NONE:
+      output = input;
+      return true;
+#ifdef HYDRA_ROS_USE_ZSTD
+    case DsgCodec::ZSTD: {
+      // the frame header records the size written by the sender
+      const auto frame_size = ZSTD_getFrameContentSize(input.data(), input.size());
+      if (frame_size == ZSTD_CONTENTSIZE_ERROR ||
+          frame_size == ZSTD_CONTENTSIZE_UNKNOWN || frame_size != uncompressed_size) {
+        LOG(ERROR) << "zstd frame does not match size of " << uncompressed_size
+                   << " bytes";
+        return false;
+      }
+
+      output.resize(uncompressed_size);
+      const auto size =
+          ZSTD_decompress(output.data(), output.size(), input.data(), input.size());
+      if (ZSTD_isError(size) || size != uncompressed_size) {
+        LOG(ERROR) << "zstd decompression failed";
+        return false;
+      }
+
+      return true;
+    }
+#endif
+#ifdef HYDRA_ROS_USE_LZ4
+    case DsgCodec::LZ4: {
+      if (uncompressed_size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return false;
+      }
+
+      output.resize(uncompressed_size);
+      const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(input.data()),
+                                           reinterpret_cast<char*>(output.data()),
+                                           input.size(),
+                                           uncompressed_size);
+      if (size < 0 || static_cast<size_t>(size) != uncompressed_size) {
+        LOG(ERROR) << "lz4 decompression failed";
+        return false;
+      }
+
+      return true;
+    }
+#endif
+    default:
+      LOG(ERROR) << "Unsupported codec: " << toString(codec) << " ("
+                 << static_cast<int>(codec) << ")";
+      return false;
+  }
+}
+
+}  // namespace hydra
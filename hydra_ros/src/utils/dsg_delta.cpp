@@ -0,0 +1,250 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/dsg_delta.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+namespace hydra {
+
+using spark_dsg::SceneGraphEdge;
+
+namespace {
+
+template <typename Func>
+void forEachNode(const DynamicSceneGraph& graph, const Func& func) {
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    for (const auto& [node_id, node] : layer->nodes()) {
+      func(*node);
+    }
+  }
+
+  // dynamic nodes are visited in index order
+  for (const auto& [layer_id, sublayers] : graph.dynamicLayers()) {
+    for (const auto& [prefix, layer] : sublayers) {
+      for (const auto& node : layer->nodes()) {
+        if (node) {
+          func(*node);
+        }
+      }
+    }
+  }
+}
+
+template <typename Func>
+void forEachEdge(const DynamicSceneGraph& graph, const Func& func) {
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    for (const auto& [key, edge] : layer->edges()) {
+      func(edge);
+    }
+  }
+
+  for (const auto& [layer_id, sublayers] : graph.dynamicLayers()) {
+    for (const auto& [prefix, layer] : sublayers) {
+      for (const auto& [key, edge] : layer->edges()) {
+        func(edge);
+      }
+    }
+  }
+
+  for (const auto& [key, edge] : graph.interlayer_edges()) {
+    func(edge);
+  }
+
+  for (const auto& [key, edge] : graph.dynamic_interlayer_edges()) {
+    func(edge);
+  }
+}
+
+inline std::pair<NodeId, NodeId> edgeKey(NodeId source, NodeId target) {
+  return std::minmax(source, target);
+}
+
+}  // namespace
+
+void DsgDeltaTracker::reset(const DynamicSceneGraph& graph) {
+  nodes_.clear();
+  edges_.clear();
+  forEachNode(graph, [this](const SceneGraphNode& node) {
+    nodes_.emplace(node.id, node.attributes().clone());
+  });
+  forEachEdge(graph, [this](const SceneGraphEdge& edge) {
+    edges_.emplace(edgeKey(edge.source, edge.target), edge.attributes().clone());
+  });
+}
+
+DsgDelta DsgDeltaTracker::update(const DynamicSceneGraph& graph) {
+  DsgDelta delta;
+  delta.graph = std::make_shared<DynamicSceneGraph>(graph.layer_ids);
+
+  std::unordered_set<NodeId> seen_nodes;
+  std::set<NodeId> changed_nodes;
+  forEachNode(graph, [&](const SceneGraphNode& node) {
+    seen_nodes.insert(node.id);
+    auto iter = nodes_.find(node.id);
+    if (iter != nodes_.end() && *iter->second == node.attributes()) {
+      return;
+    }
+
+    nodes_[node.id] = node.attributes().clone();
+    changed_nodes.insert(node.id);
+  });
+
+  for (auto iter = nodes_.begin(); iter != nodes_.end();) {
+    if (seen_nodes.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    delta.deleted_nodes.push_back(iter->first);
+    iter = nodes_.erase(iter);
+  }
+
+  std::set<EdgeKey> seen_edges;
+  std::vector<const SceneGraphEdge*> changed_edges;
+  forEachEdge(graph, [&](const SceneGraphEdge& edge) {
+    const auto key = edgeKey(edge.source, edge.target);
+    seen_edges.insert(key);
+    auto iter = edges_.find(key);
+    if (iter != edges_.end() && *iter->second == edge.attributes()) {
+      return;
+    }
+
+    edges_[key] = edge.attributes().clone();
+    changed_edges.push_back(&edge);
+    // both endpoints have to be present in the delta to add the edge
+    changed_nodes.insert(edge.source);
+    changed_nodes.insert(edge.target);
+  });
+
+  for (auto iter = edges_.begin(); iter != edges_.end();) {
+    if (seen_edges.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    delta.deleted_edges.push_back(iter->first);
+    iter = edges_.erase(iter);
+  }
+
+  // dynamic nodes keep their index (and id) in the delta, leaving gaps before them
+  for (const auto node_id : changed_nodes) {
+    const auto& node = graph.getNode(node_id);
+    delta.graph->addOrUpdateNode(
+        node.layer, node.id, node.attributes().clone(), node.timestamp);
+  }
+
+  for (const auto edge : changed_edges) {
+    delta.graph->insertEdge(edge->source, edge->target, edge->attributes().clone());
+  }
+
+  VLOG(5) << "DSG delta: " << changed_nodes.size() << " nodes, "
+          << changed_edges.size() << " edges, " << delta.deleted_nodes.size()
+          << " deleted nodes, " << delta.deleted_edges.size() << " deleted edges";
+  return delta;
+}
+
+DsgSequenceTracker::Action DsgSequenceTracker::receive(int64_t sequence_number,
+                                                       bool full_update) {
+  const bool in_sequence = last_sequence_number_ &&
+                           sequence_number == *last_sequence_number_ + 1;
+  last_sequence_number_ = sequence_number;
+  if (full_update) {
+    has_keyframe_ = true;
+    waiting_for_keyframe_ = false;
+    return Action::APPLY;
+  }
+
+  if (has_keyframe_ && in_sequence && !waiting_for_keyframe_) {
+    return Action::APPLY;
+  }
+
+  if (waiting_for_keyframe_) {
+    return Action::DROP;
+  }
+
+  waiting_for_keyframe_ = true;
+  return Action::DROP_AND_REQUEST_KEYFRAME;
+}
+
+void applyDelta(DynamicSceneGraph& graph,
+                const DynamicSceneGraph& delta,
+                const std::vector<NodeId>& deleted_nodes,
+                const std::vector<std::pair<NodeId, NodeId>>& deleted_edges) {
+  forEachNode(delta, [&graph](const SceneGraphNode& node) {
+    graph.addOrUpdateNode(
+        node.layer, node.id, node.attributes().clone(), node.timestamp);
+  });
+
+  forEachEdge(delta, [&graph](const SceneGraphEdge& edge) {
+    graph.addOrUpdateEdge(edge.source, edge.target, edge.attributes().clone());
+  });
+
+  for (const auto& [source, target] : deleted_edges) {
+    graph.removeEdge(source, target);
+  }
+
+  for (const auto node_id : deleted_nodes) {
+    graph.removeNode(node_id);
+  }
+
+  if (delta.mesh()) {
+    graph.setMesh(delta.mesh());
+  }
+}
+
+DynamicSceneGraph::Ptr extractLayers(const DynamicSceneGraph& graph,
+                                     const std::set<LayerId>& layers) {
+  auto result = std::make_shared<DynamicSceneGraph>(graph.layer_ids);
+  forEachNode(graph, [&](const SceneGraphNode& node) {
+    if (layers.count(node.layer)) {
+      result->addOrUpdateNode(
+          node.layer, node.id, node.attributes().clone(), node.timestamp);
+    }
+  });
+
+  forEachEdge(graph, [&result](const SceneGraphEdge& edge) {
+    if (result->hasNode(edge.source) && result->hasNode(edge.target)) {
+      result->insertEdge(edge.source, edge.target, edge.attributes().clone());
+    }
+  });
+
+  return result;
+}
+
+}  // namespace hydra
@@ -43,8 +43,20 @@
 #include <kimera_pgmo_ros/conversion/ros_conversion.h>
 #include <spark_dsg/serialization/graph_binary_serialization.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
 namespace hydra {
 
+using DsgUpdateMsg = hydra_msgs::DsgUpdate;
+static_assert(static_cast<uint8_t>(DsgCodec::NONE) == DsgUpdateMsg::CODEC_NONE);
+static_assert(static_cast<uint8_t>(DsgCodec::ZSTD) == DsgUpdateMsg::CODEC_ZSTD);
+static_assert(static_cast<uint8_t>(DsgCodec::LZ4) == DsgUpdateMsg::CODEC_LZ4);
+
+// a dropped delta costs a keyframe, so updates are queued on both ends
+constexpr uint32_t kUpdateQueueSize = 10;
+
 DsgSender::DsgSender(const ros::NodeHandle& nh,
                      const std::string& frame_id,
                      const std::string& timer_name,
@@ -56,24 +68,171 @@ DsgSender::DsgSender(const ros::NodeHandle& nh,
       timer_name_(timer_name),
       publish_mesh_(publish_mesh),
       min_mesh_separation_s_(min_mesh_separation_s),
-      serialize_dsg_mesh_(serialize_dsg_mesh) {
-  pub_ = nh_.advertise<hydra_msgs::DsgUpdate>("dsg", 1);
+      serialize_dsg_mesh_(serialize_dsg_mesh),
+      keyframe_period_(0),
+      codec_(DsgCodec::NONE),
+      compression_level_(1),
+      snapshot_timeout_s_(1.0),
+      latest_is_current_(false),
+      snapshot_requested_(false) {
+  // deltas are opt-in since not every consumer applies them (e.g., DsgSubscriber)
+  nh_.param("dsg_keyframe_period", keyframe_period_, keyframe_period_);
+  std::string codec = "none";
+  nh_.param("dsg_codec", codec, codec);
+  nh_.param("dsg_snapshot_timeout_s", snapshot_timeout_s_, snapshot_timeout_s_);
+  codec_ = parseDsgCodec(codec);
+  if (!hasDsgCodec(codec_)) {
+    LOG(WARNING) << "Codec '" << codec << "' not available: sending uncompressed";
+    codec_ = DsgCodec::NONE;
+  }
+
+  // each codec has its own default (lz4 levels above 1 select the slow HC compressor)
+  compression_level_ = defaultDsgCompressionLevel(codec_);
+  nh_.param("dsg_compression_level", compression_level_, compression_level_);
+
+  streams_.push_back(std::make_unique<Stream>());
+  advertise(*streams_.front(), "dsg");
+  loadProfiles();
   if (publish_mesh_) {
     mesh_pub_ = nh_.advertise<kimera_pgmo_msgs::KimeraPgmoMesh>("dsg_mesh", 1, false);
   }
+
+  thread_ = std::thread(&DsgSender::spin, this);
+
+  ros::NodeHandle snapshot_nh(nh_);
+  snapshot_nh.setCallbackQueue(&snapshot_queue_);
+  snapshot_srv_ =
+      snapshot_nh.advertiseService("get_dsg", &DsgSender::handleGetDsg, this);
+  snapshot_spinner_ = std::make_unique<ros::AsyncSpinner>(1, &snapshot_queue_);
+  snapshot_spinner_->start();
+}
+
+DsgSender::~DsgSender() {
+  // a running request finishes before the state it uses is destroyed
+  snapshot_srv_.shutdown();
+  snapshot_spinner_->stop();
+
+  // the publishing thread sends the last snapshot before exiting
+  mailbox_.shutdown();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
 }
 
 void DsgSender::sendGraph(const DynamicSceneGraph& graph,
                           const ros::Time& stamp) const {
-  const uint64_t timestamp_ns = stamp.toNSec();
-  timing::ScopedTimer timer(timer_name_, timestamp_ns);
+  // only measures the time the caller is blocked
+  timing::ScopedTimer timer(timer_name_, stamp.toNSec());
+  bool has_subscribers = publish_mesh_ && mesh_pub_.getNumSubscribers();
+  for (const auto& stream : streams_) {
+    has_subscribers |= stream->numSubscribers() > 0;
+  }
 
-  if (pub_.getNumSubscribers()) {
-    hydra_msgs::DsgUpdate msg;
-    msg.header.stamp = stamp;
-    spark_dsg::io::binary::writeGraph(graph, msg.layer_contents, serialize_dsg_mesh_);
-    msg.full_update = true;
-    pub_.publish(msg);
+  const bool snapshot_requested = snapshot_requested_.exchange(false);
+  if (!has_subscribers && !snapshot_requested) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_is_current_ = false;
+    return;
+  }
+
+  Snapshot snapshot{graph.clone(), stamp};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = snapshot;
+    latest_is_current_ = true;
+  }
+
+  if (has_subscribers) {
+    mailbox_.put(std::move(snapshot));
+  }
+
+  if (snapshot_requested) {
+    snapshot_cv_.notify_all();
+  }
+}
+
+size_t DsgSender::numCoalesced() const { return mailbox_.numCoalesced(); }
+
+void DsgSender::spin() {
+  while (const auto snapshot = mailbox_.take()) {
+    publish(*snapshot->graph, snapshot->stamp);
+  }
+}
+
+uint32_t DsgSender::Stream::numSubscribers() const {
+  uint32_t num_subscribers = 0;
+  for (const auto& pub : pubs) {
+    num_subscribers += pub.getNumSubscribers();
+  }
+
+  return num_subscribers;
+}
+
+void DsgSender::advertise(Stream& stream, const std::string& topic) {
+  stream.pubs.push_back(nh_.advertise<hydra_msgs::DsgUpdate>(topic, kUpdateQueueSize));
+  // uses the resolved topic so that requests follow any remapping of the graph topic
+  auto* requested = &stream.keyframe_requested;
+  stream.keyframe_subs.push_back(ros::NodeHandle().subscribe<std_msgs::Empty>(
+      stream.pubs.back().getTopic() + "/keyframe_request",
+      10,
+      [requested](const std_msgs::Empty::ConstPtr&) { *requested = true; }));
+}
+
+void DsgSender::loadProfiles() {
+  XmlRpc::XmlRpcValue profiles;
+  if (!nh_.getParam("dsg_profiles", profiles)) {
+    return;
+  }
+
+  if (profiles.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+    LOG(ERROR) << "Invalid 'dsg_profiles': expected a map from name to profile";
+    return;
+  }
+
+  for (auto& [name, profile] : profiles) {
+    if (name == "keyframe_request" || !profile.hasMember("layers") ||
+        profile["layers"].getType() != XmlRpc::XmlRpcValue::TypeArray) {
+      LOG(ERROR) << "Invalid dsg profile '" << name << "': skipping";
+      continue;
+    }
+
+    std::set<LayerId> layers;
+    auto& layer_values = profile["layers"];
+    for (int i = 0; i < layer_values.size(); ++i) {
+      layers.insert(static_cast<int>(layer_values[i]));
+    }
+
+    if (layers.empty()) {
+      LOG(ERROR) << "Dsg profile '" << name << "' selects no layers: skipping";
+      continue;
+    }
+
+    const bool include_mesh =
+        profile.hasMember("include_mesh") && static_cast<bool>(profile["include_mesh"]);
+
+    // profiles that select the same layers are only serialized once
+    const auto matches = [&](const auto& other) {
+      return other->layers == layers && other->include_mesh == include_mesh;
+    };
+    auto iter = std::find_if(streams_.begin() + 1, streams_.end(), matches);
+    if (iter == streams_.end()) {
+      streams_.push_back(std::make_unique<Stream>());
+      streams_.back()->layers = layers;
+      streams_.back()->include_mesh = include_mesh;
+      iter = std::prev(streams_.end());
+    }
+
+    advertise(**iter, "dsg/" + name);
+    VLOG(1) << "Publishing dsg profile '" << name << "' with " << layers.size()
+            << " layer(s)" << (include_mesh ? " and the mesh" : "");
+  }
+}
+
+void DsgSender::publish(const DynamicSceneGraph& graph, const ros::Time& stamp) {
+  const uint64_t timestamp_ns = stamp.toNSec();
+  timing::ScopedTimer timer(timer_name_ + "_publish", timestamp_ns);
+  for (auto& stream : streams_) {
+    publishStream(*stream, graph, stamp);
   }
 
   if (!publish_mesh_ || !mesh_pub_.getNumSubscribers()) {
@@ -101,9 +260,132 @@ void DsgSender::sendGraph(const DynamicSceneGraph& graph,
   mesh_pub_.publish(msg);
 }
 
+void DsgSender::publishStream(Stream& stream,
+                              const DynamicSceneGraph& full_graph,
+                              const ros::Time& stamp) {
+  const auto num_subscribers = stream.numSubscribers();
+  const bool has_new_subscribers = num_subscribers > stream.last_num_subscribers;
+  stream.last_num_subscribers = num_subscribers;
+  if (!num_subscribers) {
+    return;
+  }
+
+  DynamicSceneGraph::Ptr subset;
+  const bool serialize_mesh = serialize_dsg_mesh_ && stream.include_mesh;
+  if (!stream.layers.empty()) {
+    subset = extractLayers(full_graph, stream.layers);
+    if (serialize_mesh) {
+      subset->setMesh(full_graph.mesh());
+    }
+  }
+
+  const auto& graph = subset ? *subset : full_graph;
+
+  hydra_msgs::DsgUpdate msg;
+  msg.header.stamp = stamp;
+  msg.sequence_number = stream.sequence_number++;
+  // new subscribers need the entire graph
+  const bool requested = stream.keyframe_requested.exchange(false);
+  const bool send_keyframe = keyframe_period_ <= 0 || requested ||
+                             has_new_subscribers ||
+                             stream.updates_since_keyframe + 1 >= keyframe_period_;
+  std::vector<uint8_t> payload;
+  if (send_keyframe) {
+    spark_dsg::io::binary::writeGraph(graph, payload, serialize_mesh);
+    msg.full_update = true;
+    stream.updates_since_keyframe = 0;
+    if (keyframe_period_ > 0) {
+      stream.tracker.reset(graph);
+    }
+  } else {
+    const auto delta = stream.tracker.update(graph);
+    if (serialize_mesh) {
+      // the mesh is not delta encoded
+      delta.graph->setMesh(graph.mesh());
+    }
+
+    spark_dsg::io::binary::writeGraph(*delta.graph, payload, serialize_mesh);
+    msg.deleted_nodes = delta.deleted_nodes;
+    for (const auto& [source, target] : delta.deleted_edges) {
+      msg.deleted_edges.push_back(source);
+      msg.deleted_edges.push_back(target);
+    }
+
+    msg.full_update = false;
+    ++stream.updates_since_keyframe;
+  }
+
+  setContents(std::move(payload), msg);
+  for (const auto& pub : stream.pubs) {
+    if (pub.getNumSubscribers()) {
+      pub.publish(msg);
+    }
+  }
+}
+
+void DsgSender::setContents(std::vector<uint8_t>&& payload,
+                            hydra_msgs::DsgUpdate& msg) const {
+  msg.uncompressed_size = payload.size();
+  msg.codec = hydra_msgs::DsgUpdate::CODEC_NONE;
+  if (codec_ != DsgCodec::NONE &&
+      compressDsg(codec_, compression_level_, payload, msg.layer_contents)) {
+    msg.codec = static_cast<uint8_t>(codec_);
+  } else {
+    msg.layer_contents = std::move(payload);
+  }
+}
+
+bool DsgSender::handleGetDsg(hydra_msgs::GetDsg::Request& req,
+                             hydra_msgs::GetDsg::Response& res) {
+  Snapshot snapshot;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!latest_is_current_) {
+      // the next update copies the graph even if nothing is subscribed
+      snapshot_requested_ = true;
+      const std::chrono::duration<double> timeout(snapshot_timeout_s_);
+      const auto updated = [this] { return latest_is_current_; };
+      if (!snapshot_cv_.wait_for(lock, timeout, updated)) {
+        LOG_IF(WARNING, latest_.graph)
+            << "No dsg update within " << snapshot_timeout_s_
+            << " [s]: sending last snapshot @ " << latest_.stamp.toNSec() << " [ns]";
+      }
+    }
+
+    snapshot = latest_;
+  }
+
+  if (!snapshot.graph) {
+    LOG(ERROR) << "No scene graph available for snapshot";
+    return false;
+  }
+
+  // serialized outside the lock: the snapshot is never modified once copied
+  timing::ScopedTimer timer(timer_name_ + "_snapshot", snapshot.stamp.toNSec());
+  DynamicSceneGraph::Ptr subset;
+  if (!req.layers.empty()) {
+    subset = extractLayers(*snapshot.graph,
+                           std::set<LayerId>(req.layers.begin(), req.layers.end()));
+    subset->setMesh(snapshot.graph->mesh());
+  }
+
+  const auto& graph = subset ? *subset : *snapshot.graph;
+  std::vector<uint8_t> payload;
+  spark_dsg::io::binary::writeGraph(graph, payload, req.include_mesh);
+
+  auto& msg = res.graph;
+  msg.header.stamp = snapshot.stamp;
+  msg.header.frame_id = frame_id_;
+  msg.full_update = true;
+  setContents(std::move(payload), msg);
+  return true;
+}
+
 DsgReceiver::DsgReceiver(const ros::NodeHandle& nh, bool subscribe_to_mesh)
     : nh_(nh), has_update_(false), graph_(nullptr) {
-  sub_ = nh_.subscribe("dsg", 1, &DsgReceiver::handleUpdate, this);
+  sub_ = nh_.subscribe("dsg", kUpdateQueueSize, &DsgReceiver::handleUpdate, this);
+  keyframe_pub_ = ros::NodeHandle().advertise<std_msgs::Empty>(
+      sub_.getTopic() + "/keyframe_request", 1);
   if (subscribe_to_mesh) {
     mesh_sub_ = nh_.subscribe("dsg_mesh_updates", 1, &DsgReceiver::handleMesh, this);
   }
@@ -116,21 +398,38 @@ DsgReceiver::DsgReceiver(const ros::NodeHandle& nh, const LogCallback& log_cb)
 
 void DsgReceiver::handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) {
   timing::ScopedTimer timer("receive_dsg", msg->header.stamp.toNSec());
-  if (!msg->full_update) {
-    throw std::runtime_error("not implemented");
+  // messages from senders without compression support leave the size unset
+  const auto codec = static_cast<DsgCodec>(msg->codec);
+  const size_t uncompressed_size = codec == DsgCodec::NONE
+                                       ? msg->layer_contents.size()
+                                       : msg->uncompressed_size;
+  if (log_callback_) {
+    (*log_callback_)(msg->header.stamp, msg->layer_contents.size(), uncompressed_size);
   }
 
-  if (log_callback_) {
-    (*log_callback_)(msg->header.stamp, msg->layer_contents.size());
+  VLOG(5) << "Received dsg update message of "
+          << getHumanReadableMemoryString(msg->layer_contents.size()) << " ("
+          << getHumanReadableMemoryString(uncompressed_size) << " uncompressed, "
+          << toString(codec) << ")";
+
+  switch (sequence_.receive(msg->sequence_number, msg->full_update)) {
+    case DsgSequenceTracker::Action::DROP:
+      return;
+    case DsgSequenceTracker::Action::DROP_AND_REQUEST_KEYFRAME:
+      LOG(WARNING) << "Missed dsg update before " << msg->sequence_number
+                   << ": waiting for next keyframe";
+      requestKeyframe();
+      return;
+    case DsgSequenceTracker::Action::APPLY:
+    default:
+      break;
   }
 
-  const auto size_bytes = getHumanReadableMemoryString(msg->layer_contents.size());
-  VLOG(5) << "Received dsg update message of " << size_bytes;
   try {
-    if (!graph_) {
-      graph_ = spark_dsg::io::binary::readGraph(msg->layer_contents);
-    } else {
-      spark_dsg::io::binary::updateGraph(*graph_, msg->layer_contents);
+    if (!applyUpdate(*msg)) {
+      sequence_.markFailed();
+      requestKeyframe();
+      return;
     }
     has_update_ = true;
   } catch (const std::exception& e) {
@@ -144,6 +443,49 @@ void DsgReceiver::handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) {
   }
 }
 
+bool DsgReceiver::applyUpdate(const hydra_msgs::DsgUpdate& msg) {
+  const auto codec = static_cast<DsgCodec>(msg.codec);
+  std::vector<uint8_t> decompressed;
+  if (codec != DsgCodec::NONE &&
+      !decompressDsg(codec, msg.layer_contents, msg.uncompressed_size, decompressed)) {
+    LOG(ERROR) << "Failed to decompress dsg update " << msg.sequence_number;
+    return false;
+  }
+
+  const auto& contents = codec == DsgCodec::NONE ? msg.layer_contents : decompressed;
+  if (msg.full_update) {
+    if (!graph_) {
+      graph_ = spark_dsg::io::binary::readGraph(contents);
+    } else {
+      spark_dsg::io::binary::updateGraph(*graph_, contents);
+    }
+
+    return true;
+  }
+
+  if (!graph_) {
+    return false;
+  }
+
+  if (msg.deleted_edges.size() % 2 != 0) {
+    LOG(ERROR) << "Invalid deleted edges in dsg update " << msg.sequence_number;
+    return false;
+  }
+
+  std::vector<std::pair<NodeId, NodeId>> deleted_edges;
+  for (size_t i = 0; i < msg.deleted_edges.size(); i += 2) {
+    deleted_edges.emplace_back(msg.deleted_edges[i], msg.deleted_edges[i + 1]);
+  }
+
+  const auto delta = spark_dsg::io::binary::readGraph(contents);
+  applyDelta(*graph_, *delta, msg.deleted_nodes, deleted_edges);
+  return true;
+}
+
+void DsgReceiver::requestKeyframe() {
+  keyframe_pub_.publish(std_msgs::Empty());
+}
+
 void DsgReceiver::handleMesh(const kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr& msg) {
   if (!msg) {
     return;
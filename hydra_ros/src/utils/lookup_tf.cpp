@@ -39,14 +39,17 @@
 #include <tf2_eigen/tf2_eigen.h>
 #include <tf2_ros/transform_listener.h>
 
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/static_tf_cache.h"
+
 namespace hydra {
 
 PoseStatus lookupTransform(const std::string& target,
                            const std::string& source,
                            double wait_duration_s,
                            int verbosity) {
-  tf2_ros::Buffer buffer;
-  tf2_ros::TransformListener listener(buffer);
+  // every caller shares one listener, so /tf_static only has to arrive once
+  const auto& buffer = StaticTfCache::instance().liveBuffer();
   return lookupTransform(
       buffer, std::nullopt, target, source, std::nullopt, wait_duration_s, verbosity);
 }
@@ -73,7 +76,8 @@ PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
 
   const auto lookup_time = stamp.value_or(ros::Time());
   size_t attempt_number = 0;
-  while (ros::ok()) {
+  // listeners spin their own threads, so waiting never services a callback queue
+  while (keepWaiting()) {
     VLOG(verbosity) << "Attempting to lookup tf @ " << lookup_time.toNSec()
                     << " [ns]: " << attempt_number << " / "
                     << (max_tries ? std::to_string(max_tries.value()) : "n/a");
@@ -88,7 +92,6 @@ PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
 
     ++attempt_number;
     tf_wait_rate.sleep();
-    ros::spinOnce();
   }
 
   if (!have_transform) {
@@ -37,13 +37,26 @@
 #include <glog/logging.h>
 #include <hydra/common/global_info.h>
 #include <hydra/utils/timing_utilities.h>
+#include <ros/names.h>
 #include <ros/topic_manager.h>
 #include <rosgraph_msgs/Clock.h>
 
+#include <atomic>
+#include <mutex>
+#include <optional>
+
 namespace hydra {
 
 using timing::ElapsedTimeRecorder;
 
+namespace {
+
+std::mutex g_node_handle_mutex;
+std::optional<ros::NodeHandle> g_private_nh;
+std::atomic<bool> g_waits_interrupted(false);
+
+}  // namespace
+
 bool haveClock() {
   size_t num_pubs = ros::TopicManager::instance()->getNumPublishers("/clock");
   return num_pubs > 0;
@@ -113,4 +126,30 @@ void spinAndWait(const ros::NodeHandle& nh) {
   }
 }
 
+void setPrivateNodeHandle(const ros::NodeHandle& nh) {
+  std::lock_guard<std::mutex> lock(g_node_handle_mutex);
+  g_private_nh = nh;
+}
+
+ros::NodeHandle getNodeHandle(const std::string& ns) {
+  std::lock_guard<std::mutex> lock(g_node_handle_mutex);
+  if (!g_private_nh) {
+    return ros::NodeHandle(ns);
+  }
+
+  if (!ns.empty() && ns[0] == '~') {
+    const auto sub_ns = ns.substr(ns.size() > 1 && ns[1] == '/' ? 2 : 1);
+    return sub_ns.empty() ? *g_private_nh : ros::NodeHandle(*g_private_nh, sub_ns);
+  }
+
+  // relative names resolve against the parent of the private namespace
+  ros::NodeHandle parent(ros::names::parentNamespace(g_private_nh->getNamespace()));
+  parent.setCallbackQueue(g_private_nh->getCallbackQueue());
+  return ros::NodeHandle(parent, ns);
+}
+
+void interruptWaits(bool interrupt) { g_waits_interrupted = interrupt; }
+
+bool keepWaiting() { return ros::ok() && !g_waits_interrupted; }
+
 }  // namespace hydra
@@ -42,6 +42,8 @@
 #include <hydra/common/global_info.h>
 #include <nav_msgs/OccupancyGrid.h>
 
+#include "hydra_ros/utils/node_utilities.h"
+
 namespace hydra {
 
 template <typename T>
@@ -275,10 +277,10 @@ void OccupancyPublisher::publishGvd(uint64_t timestamp_ns,
 
 TsdfOccupancyPublisher::TsdfOccupancyPublisher(const Config& config)
     : config(config),
-      pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+      pub_(OccupancyPublisher(config.extraction, getNodeHandle(config.ns))) {}
 
 GvdOccupancyPublisher::GvdOccupancyPublisher(const Config& config)
-    : pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+    : pub_(OccupancyPublisher(config.extraction, getNodeHandle(config.ns))) {}
 
 void TsdfOccupancyPublisher::call(uint64_t timestamp_ns,
                                   const Eigen::Isometry3d& world_T_sensor,
@@ -0,0 +1,199 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/ply_mesh_writer.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+#include <cstdio>
+
+namespace hydra {
+
+namespace {
+
+// element counts are written with a fixed width so they can be patched in place
+constexpr int kCountWidth = 10;
+
+inline std::string formatCount(size_t count) {
+  char buffer[kCountWidth + 1];
+  std::snprintf(buffer, sizeof(buffer), "%0*zu", kCountWidth, count);
+  return buffer;
+}
+
+template <typename T>
+inline void writeBinary(std::ostream& out, const T& value) {
+  // PLY is written as little endian, which matches every platform we build for
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+size_t PlyMeshWriter::KeyHash::operator()(const Key& key) const {
+  // standard spatial hashing primes (Teschner et al.)
+  return static_cast<size_t>(key.x) * 73856093 ^ static_cast<size_t>(key.y) * 19349669 ^
+         static_cast<size_t>(key.z) * 83492791;
+}
+
+PlyMeshWriter::PlyMeshWriter(const std::filesystem::path& path,
+                             double weld_resolution,
+                             double block_size,
+                             double boundary_width)
+    : path_(path),
+      faces_path_(std::filesystem::path(path).concat(".faces.tmp")),
+      inv_resolution_(1.0 / weld_resolution),
+      block_size_(block_size),
+      // the weld resolution covers vertices that land just outside the band
+      boundary_width_(boundary_width + weld_resolution),
+      finished_(false),
+      out_(path, std::ios::binary | std::ios::trunc),
+      faces_(faces_path_, std::ios::binary | std::ios::trunc),
+      num_vertices_(0),
+      num_faces_(0),
+      num_welded_(0) {
+  CHECK_GT(weld_resolution, 0.0) << "weld resolution must be positive";
+  out_ << "ply\n"
+       << "format binary_little_endian 1.0\n"
+       << "comment written by hydra_ros\n"
+       << "element vertex ";
+  vertex_count_pos_ = out_.tellp();
+  out_ << formatCount(0) << "\n"
+       << "property float x\n"
+       << "property float y\n"
+       << "property float z\n"
+       << "property uchar red\n"
+       << "property uchar green\n"
+       << "property uchar blue\n"
+       << "element face ";
+  face_count_pos_ = out_.tellp();
+  out_ << formatCount(0) << "\n"
+       << "property list uchar uint vertex_indices\n"
+       << "end_header\n";
+}
+
+PlyMeshWriter::~PlyMeshWriter() {
+  if (!finished_) {
+    finish();
+  }
+}
+
+bool PlyMeshWriter::onBoundary(const Eigen::Vector3f& pos) const {
+  if (block_size_ <= 0.0) {
+    return true;
+  }
+
+  for (int d = 0; d < 3; ++d) {
+    const double offset = pos[d] - block_size_ * std::floor(pos[d] / block_size_);
+    if (offset < boundary_width_ || block_size_ - offset < boundary_width_) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void PlyMeshWriter::addMesh(const spark_dsg::Mesh& mesh) {
+  remap_.resize(mesh.numVertices());
+  block_index_.clear();
+  for (size_t i = 0; i < mesh.numVertices(); ++i) {
+    const auto& pos = mesh.pos(i);
+    const Key key{std::llround(pos.x() * inv_resolution_),
+                  std::llround(pos.y() * inv_resolution_),
+                  std::llround(pos.z() * inv_resolution_)};
+    auto& index = onBoundary(pos) ? index_ : block_index_;
+    const auto [iter, is_new] = index.emplace(key, num_vertices_);
+    remap_[i] = iter->second;
+    if (!is_new) {
+      ++num_welded_;
+      continue;
+    }
+
+    ++num_vertices_;
+    writeBinary(out_, pos.x());
+    writeBinary(out_, pos.y());
+    writeBinary(out_, pos.z());
+    const auto color = mesh.has_colors && i < mesh.colors.size() ? mesh.color(i)
+                                                                 : spark_dsg::Color();
+    writeBinary(out_, color.r);
+    writeBinary(out_, color.g);
+    writeBinary(out_, color.b);
+  }
+
+  for (size_t i = 0; i < mesh.numFaces(); ++i) {
+    const auto& face = mesh.face(i);
+    const uint32_t v0 = remap_.at(face[0]);
+    const uint32_t v1 = remap_.at(face[1]);
+    const uint32_t v2 = remap_.at(face[2]);
+    if (v0 == v1 || v1 == v2 || v2 == v0) {
+      continue;  // collapsed by welding
+    }
+
+    ++num_faces_;
+    writeBinary(faces_, static_cast<uint8_t>(3));
+    writeBinary(faces_, v0);
+    writeBinary(faces_, v1);
+    writeBinary(faces_, v2);
+  }
+}
+
+bool PlyMeshWriter::finish() {
+  finished_ = true;
+  faces_.close();
+  const bool faces_valid = static_cast<bool>(faces_);
+  {
+    std::ifstream faces(faces_path_, std::ios::binary);
+    if (num_faces_) {
+      out_ << faces.rdbuf();
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::remove(faces_path_, ec);
+
+  out_.seekp(vertex_count_pos_);
+  out_ << formatCount(num_vertices_);
+  out_.seekp(face_count_pos_);
+  out_ << formatCount(num_faces_);
+  out_.close();
+  index_.clear();
+  block_index_.clear();
+  if (!out_ || !faces_valid) {
+    LOG(ERROR) << "Failed to write mesh to " << path_;
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace hydra
@@ -47,17 +47,62 @@
 
 namespace hydra {
 
-void fillBuffer(const rosbag::Bag& bag,
-                bool static_only,
-                std::shared_ptr<tf2::BufferCore>& buffer) {
+PoseCache::Backend parseBackend(const std::string& backend) {
+  return backend == "tf2" ? PoseCache::Backend::TF2 : PoseCache::Backend::TIMELINE;
+}
+
+PoseCache::PoseCache(const PoseCache::Config& config) {
+  config::checkValid(config);
+  LOG(INFO) << "Loading poses from " << config.bag_path;
+
+  rosbag::Bag bag;
+  bag.open(config.bag_path, rosbag::bagmode::Read);
+  fill(bag, config.static_only, parseBackend(config.backend), config.use_index);
+  bag.close();
+}
+
+PoseCache::PoseCache(const rosbag::Bag& bag,
+                     bool static_only,
+                     Backend backend,
+                     bool use_index) {
+  fill(bag, static_only, backend, use_index);
+}
+
+std::filesystem::path PoseCache::indexPath(const std::filesystem::path& bag_path,
+                                           bool static_only) {
+  auto path = bag_path;
+  path += static_only ? ".static_poses" : ".poses";
+  return path;
+}
+
+void PoseCache::fill(const rosbag::Bag& bag,
+                     bool static_only,
+                     Backend backend,
+                     bool use_index) {
+  use_index &= backend == Backend::TIMELINE;
+  const std::filesystem::path bag_path = bag.getFileName();
+  const auto index_path = indexPath(bag_path, static_only);
+  const auto key = PoseTimeline::IndexKey::fromFile(bag_path, static_only);
+  if (use_index) {
+    timeline_ = PoseTimeline::mapIndex(index_path, key);
+    if (timeline_) {
+      VLOG(1) << "Mapped poses from " << index_path;
+      return;
+    }
+  }
+
   std::vector<std::string> topics{"/tf_static"};
   if (!static_only) {
     topics.push_back("/tf");
   }
 
   rosbag::View view(bag, rosbag::TopicQuery(topics));
-  const auto bag_duration = view.getEndTime() - view.getBeginTime();
-  buffer = std::make_shared<tf2::BufferCore>(bag_duration + ros::Duration(10.0));
+  if (backend == Backend::TF2) {
+    const auto bag_duration = view.getEndTime() - view.getBeginTime();
+    buffer_ = std::make_shared<tf2::BufferCore>(bag_duration + ros::Duration(10.0));
+  } else {
+    timeline_ = std::make_shared<PoseTimeline>();
+  }
 
   for (const auto& m : view) {
     const auto msg = m.instantiate<tf2_msgs::TFMessage>();
@@ -68,30 +113,51 @@ void fillBuffer(const rosbag::Bag& bag,
 
     const bool is_static = m.getTopic() == "/tf_static";
     for (const auto& tf : msg->transforms) {
-      buffer->setTransform(tf, "rosbag", is_static);
+      if (buffer_) {
+        buffer_->setTransform(tf, "rosbag", is_static);
+        continue;
+      }
+
+      const auto& t = tf.transform.translation;
+      const auto& q = tf.transform.rotation;
+      timeline_->add(tf.header.frame_id,
+                     tf.child_frame_id,
+                     tf.header.stamp.toNSec(),
+                     Eigen::Vector3d(t.x, t.y, t.z),
+                     Eigen::Quaterniond(q.w, q.x, q.y, q.z),
+                     is_static);
     }
   }
-}
 
-PoseCache::PoseCache(const PoseCache::Config& config) {
-  config::checkValid(config);
-  LOG(INFO) << "Loading poses from " << config.bag_path;
-
-
-  rosbag::Bag bag;
-  bag.open(config.bag_path, rosbag::bagmode::Read);
-  fillBuffer(bag, config.static_only, buffer_);
-  bag.close();
-}
+  if (!timeline_) {
+    return;
+  }
 
-PoseCache::PoseCache(const rosbag::Bag& bag, bool static_only) {
-  fillBuffer(bag, static_only, buffer_);
+  timeline_->finalize();
+  if (use_index && !timeline_->writeIndex(index_path, key)) {
+    LOG(WARNING) << "Unable to write pose index to " << index_path;
+  }
 }
 
 PoseCache::PoseResult PoseCache::lookupPose(uint64_t timestamp_ns,
                                             const std::string& to_frame,
                                             const std::string& from_frame) const {
   PoseResult result;
+  if (timeline_) {
+    PoseTimeline::Pose pose;
+    const auto status = timeline_->lookup(timestamp_ns, to_frame, from_frame, pose);
+    if (status != PoseTimeline::Status::VALID) {
+      LOG(ERROR) << "Unable to find pose @ " << timestamp_ns << " [ns] between '"
+                 << from_frame << "' and '" << to_frame << "': " << status;
+      return result;
+    }
+
+    result.valid = true;
+    result.to_p_from = pose.to_p_from;
+    result.to_R_from = pose.to_R_from;
+    return result;
+  }
+
   try {
     ros::Time stamp;
     stamp.fromNSec(timestamp_ns);
@@ -120,6 +186,10 @@ void declare_config(PoseCache::Config& config) {
   name("RosCameraIntrinsics::Config");
   field<Path>(config.bag_path, "bag_path");
   field(config.static_only, "static_only");
+  field(config.backend, "backend");
+  field(config.use_index, "use_index");
+  checkCondition(config.backend == "timeline" || config.backend == "tf2",
+                 "backend must be 'timeline' or 'tf2'");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
 
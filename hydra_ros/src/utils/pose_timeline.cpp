@@ -0,0 +1,574 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/pose_timeline.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+inline std::string stripSlash(const std::string& frame) {
+  return !frame.empty() && frame[0] == '/' ? frame.substr(1) : frame;
+}
+
+constexpr char kIndexMagic[8] = {'H', 'Y', 'D', 'R', 'A', 'P', 'I', 'X'};
+constexpr uint32_t kIndexVersion = 1;
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t static_only;
+  uint64_t source_size;
+  int64_t source_mtime_ns;
+  uint64_t num_edges;
+  uint64_t file_size;
+};
+
+struct IndexEdge {
+  uint64_t parent_offset;
+  uint64_t parent_length;
+  uint64_t child_offset;
+  uint64_t child_length;
+  uint64_t is_static;
+  uint64_t num_samples;
+  uint64_t stamps_offset;
+  uint64_t positions_offset;
+  uint64_t rotations_offset;
+};
+
+inline uint64_t align8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+inline bool inFile(uint64_t offset, uint64_t length, uint64_t file_size) {
+  return offset <= file_size && length <= file_size - offset;
+}
+
+inline PoseTimeline::Pose compose(const PoseTimeline::Pose& a_T_b,
+                                  const PoseTimeline::Pose& b_T_c) {
+  PoseTimeline::Pose a_T_c;
+  a_T_c.to_p_from = a_T_b.to_p_from + a_T_b.to_R_from * b_T_c.to_p_from;
+  a_T_c.to_R_from = a_T_b.to_R_from * b_T_c.to_R_from;
+  return a_T_c;
+}
+
+inline PoseTimeline::Pose inverse(const PoseTimeline::Pose& a_T_b) {
+  PoseTimeline::Pose b_T_a;
+  b_T_a.to_R_from = a_T_b.to_R_from.conjugate();
+  b_T_a.to_p_from = -(b_T_a.to_R_from * a_T_b.to_p_from);
+  return b_T_a;
+}
+
+}  // namespace
+
+void PoseTimeline::Timeline::push(uint64_t stamp, const Pose& pose) {
+  const Eigen::Quaternionf q = pose.to_R_from.normalized().cast<float>();
+  stamps.push_back(stamp);
+  positions.insert(positions.end(), pose.to_p_from.data(), pose.to_p_from.data() + 3);
+  rotations.insert(rotations.end(), {q.x(), q.y(), q.z(), q.w()});
+  bind();
+}
+
+void PoseTimeline::Timeline::bind() {
+  num_samples = stamps.size();
+  stamp_data = stamps.data();
+  position_data = positions.data();
+  rotation_data = rotations.data();
+}
+
+void PoseTimeline::Timeline::finalize() {
+  if (stamps.empty()) {
+    return;  // nothing owned (e.g., mapped from an index)
+  }
+
+  std::vector<size_t> order(stamps.size());
+  std::iota(order.begin(), order.end(), 0);
+  // stable so that the last sample added wins for duplicate timestamps
+  std::stable_sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+    return stamps[lhs] < stamps[rhs];
+  });
+
+  Timeline sorted;
+  sorted.is_static = is_static;
+  sorted.stamps.reserve(order.size());
+  sorted.positions.reserve(3 * order.size());
+  sorted.rotations.reserve(4 * order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const auto idx = order[i];
+    if (i + 1 < order.size() && stamps[order[i + 1]] == stamps[idx]) {
+      continue;
+    }
+
+    sorted.stamps.push_back(stamps[idx]);
+    sorted.positions.insert(sorted.positions.end(),
+                            positions.begin() + 3 * idx,
+                            positions.begin() + 3 * idx + 3);
+    sorted.rotations.insert(sorted.rotations.end(),
+                            rotations.begin() + 4 * idx,
+                            rotations.begin() + 4 * idx + 4);
+  }
+
+  *this = std::move(sorted);
+  bind();
+}
+
+PoseTimeline::Status PoseTimeline::Timeline::interpolate(uint64_t timestamp_ns,
+                                                         Pose& pose) const {
+  const auto sample = [this](size_t idx, Eigen::Vector3d& p, Eigen::Quaterniond& q) {
+    const auto* pos = position_data + 3 * idx;
+    const auto* rot = rotation_data + 4 * idx;
+    p = Eigen::Vector3d(pos[0], pos[1], pos[2]);
+    q = Eigen::Quaterniond(rot[3], rot[0], rot[1], rot[2]);
+  };
+
+  if (num_samples == 0) {
+    return Status::EXTRAPOLATION;
+  }
+
+  if (is_static) {
+    sample(0, pose.to_p_from, pose.to_R_from);
+    return Status::VALID;
+  }
+
+  const auto begin = stamp_data;
+  const auto end = stamp_data + num_samples;
+  if (timestamp_ns < *begin || timestamp_ns > *(end - 1)) {
+    return Status::EXTRAPOLATION;
+  }
+
+  const auto iter = std::lower_bound(begin, end, timestamp_ns);
+  const size_t idx = iter - begin;
+  if (*iter == timestamp_ns) {
+    sample(idx, pose.to_p_from, pose.to_R_from);
+    return Status::VALID;
+  }
+
+  Eigen::Vector3d p0, p1;
+  Eigen::Quaterniond q0, q1;
+  sample(idx - 1, p0, q0);
+  sample(idx, p1, q1);
+  const double ratio = static_cast<double>(timestamp_ns - stamp_data[idx - 1]) /
+                       static_cast<double>(stamp_data[idx] - stamp_data[idx - 1]);
+  pose.to_p_from = p0 + ratio * (p1 - p0);
+  pose.to_R_from = q0.slerp(ratio, q1).normalized();
+  return Status::VALID;
+}
+
+PoseTimeline::Status PoseTimeline::Chain::evaluate(uint64_t timestamp_ns,
+                                                   Pose& pose) const {
+  const auto stamp = timestamp_ns == 0 ? latest_ns : timestamp_ns;
+  if (steps.empty()) {
+    return flattened.interpolate(stamp, pose);
+  }
+
+  Pose result;
+  for (const auto& step : steps) {
+    Pose curr;
+    const auto status = step.timeline->interpolate(stamp, curr);
+    if (status != Status::VALID) {
+      return status;
+    }
+
+    result = compose(result, step.inverse ? inverse(curr) : curr);
+  }
+
+  pose = result;
+  return Status::VALID;
+}
+
+void PoseTimeline::add(const std::string& parent,
+                       const std::string& child,
+                       uint64_t timestamp_ns,
+                       const Eigen::Vector3d& parent_p_child,
+                       const Eigen::Quaterniond& parent_R_child,
+                       bool is_static) {
+  const auto parent_frame = stripSlash(parent);
+  const auto child_frame = stripSlash(child);
+  auto& edge = edges_[child_frame];
+  if (edge.timeline.size() == 0) {
+    edge.parent = parent_frame;
+    edge.timeline.is_static = is_static;
+    frames_.insert(parent_frame);
+    frames_.insert(child_frame);
+  } else if (edge.parent != parent_frame) {
+    LOG(WARNING) << "Ignoring transform from '" << parent_frame << "' to '"
+                 << child_frame << "': frame already has parent '" << edge.parent
+                 << "'";
+    return;
+  }
+
+  Pose pose;
+  pose.to_p_from = parent_p_child;
+  pose.to_R_from = parent_R_child;
+  if (edge.timeline.is_static) {
+    edge.timeline = Timeline();
+    edge.timeline.is_static = true;
+  }
+
+  edge.timeline.push(timestamp_ns, pose);
+}
+
+void PoseTimeline::finalize() {
+  for (auto& id_edge_pair : edges_) {
+    id_edge_pair.second.timeline.finalize();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  chains_.clear();
+}
+
+size_t PoseTimeline::numSamples() const {
+  size_t total = 0;
+  for (const auto& id_edge_pair : edges_) {
+    total += id_edge_pair.second.timeline.size();
+  }
+
+  return total;
+}
+
+PoseTimeline::Status PoseTimeline::lookup(uint64_t timestamp_ns,
+                                          const std::string& to_frame,
+                                          const std::string& from_frame,
+                                          Pose& pose) const {
+  const auto to = stripSlash(to_frame);
+  const auto from = stripSlash(from_frame);
+  if (to == from) {
+    pose = Pose();
+    return Status::VALID;
+  }
+
+  const auto chain = getChain(to, from);
+  if (chain->status != Status::VALID) {
+    return chain->status;
+  }
+
+  return chain->evaluate(timestamp_ns, pose);
+}
+
+std::shared_ptr<const PoseTimeline::Chain> PoseTimeline::getChain(
+    const std::string& to_frame, const std::string& from_frame) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const ChainKey key{to_frame, from_frame};
+  auto iter = chains_.find(key);
+  if (iter == chains_.end()) {
+    iter = chains_.emplace(key, makeChain(to_frame, from_frame)).first;
+  }
+
+  return iter->second;
+}
+
+std::vector<std::string> PoseTimeline::getAncestors(const std::string& frame) const {
+  std::vector<std::string> ancestors{frame};
+  auto iter = edges_.find(frame);
+  // bounded by the number of edges in case the tree contains a cycle
+  while (iter != edges_.end() && ancestors.size() <= edges_.size()) {
+    ancestors.push_back(iter->second.parent);
+    iter = edges_.find(iter->second.parent);
+  }
+
+  return ancestors;
+}
+
+std::shared_ptr<const PoseTimeline::Chain> PoseTimeline::makeChain(
+    const std::string& to_frame, const std::string& from_frame) const {
+  auto chain = std::make_shared<Chain>();
+  if (!frames_.count(to_frame) || !frames_.count(from_frame)) {
+    chain->status = Status::UNKNOWN_FRAME;
+    return chain;
+  }
+
+  const auto to_ancestors = getAncestors(to_frame);
+  const auto from_ancestors = getAncestors(from_frame);
+  size_t to_idx = to_ancestors.size();
+  size_t from_idx = 0;
+  for (; from_idx < from_ancestors.size(); ++from_idx) {
+    const auto iter = std::find(
+        to_ancestors.begin(), to_ancestors.end(), from_ancestors[from_idx]);
+    if (iter != to_ancestors.end()) {
+      to_idx = iter - to_ancestors.begin();
+      break;
+    }
+  }
+
+  if (from_idx == from_ancestors.size()) {
+    chain->status = Status::NOT_CONNECTED;
+    return chain;
+  }
+
+  // to_T_from = inv(ancestor_T_to) * ancestor_T_from
+  const Timeline* dynamic = nullptr;
+  size_t num_dynamic = 0;
+  const auto add_step = [&](const std::string& child, bool inverse) {
+    const auto& timeline = edges_.at(child).timeline;
+    chain->steps.push_back({&timeline, inverse});
+    if (!timeline.is_static) {
+      ++num_dynamic;
+      dynamic = &timeline;
+      const auto last = timeline.stamp_data[timeline.size() - 1];
+      chain->latest_ns = chain->latest_ns ? std::min(chain->latest_ns, last) : last;
+    }
+  };
+
+  for (size_t i = 0; i < to_idx; ++i) {
+    add_step(to_ancestors[i], true);
+  }
+
+  for (size_t i = from_idx; i > 0; --i) {
+    add_step(from_ancestors[i - 1], false);
+  }
+
+  if (num_dynamic > 1) {
+    return chain;
+  }
+
+  // with at most one dynamic edge the composed chain can be precomputed per sample
+  Timeline flattened;
+  flattened.is_static = dynamic == nullptr;
+  const std::vector<uint64_t> stamps =
+      dynamic ? std::vector<uint64_t>(dynamic->stamp_data,
+                                      dynamic->stamp_data + dynamic->size())
+              : std::vector<uint64_t>{0};
+  flattened.stamps.reserve(stamps.size());
+  flattened.positions.reserve(3 * stamps.size());
+  flattened.rotations.reserve(4 * stamps.size());
+  for (const auto stamp : stamps) {
+    Pose pose;
+    chain->evaluate(stamp, pose);
+    flattened.push(stamp, pose);
+  }
+
+  chain->flattened = std::move(flattened);
+  chain->flattened.bind();
+  chain->steps.clear();
+  return chain;
+}
+
+PoseTimeline::IndexKey PoseTimeline::IndexKey::fromFile(
+    const std::filesystem::path& path, bool static_only) {
+  IndexKey key;
+  key.static_only = static_only;
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  if (!ec) {
+    key.source_size = size;
+  }
+
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (!ec) {
+    key.source_mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              mtime.time_since_epoch())
+                              .count();
+  }
+
+  return key;
+}
+
+bool PoseTimeline::writeIndex(const std::filesystem::path& path,
+                              const IndexKey& key) const {
+  std::vector<std::pair<const std::string*, const Edge*>> edges;
+  for (const auto& [child, edge] : edges_) {
+    edges.emplace_back(&child, &edge);
+  }
+
+  // lay out the edge table followed by the strings and samples of every edge
+  std::vector<IndexEdge> records(edges.size());
+  uint64_t offset = sizeof(IndexHeader) + records.size() * sizeof(IndexEdge);
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const auto& timeline = edges[i].second->timeline;
+    auto& record = records[i];
+    record.parent_offset = offset;
+    record.parent_length = edges[i].second->parent.size();
+    record.child_offset = record.parent_offset + record.parent_length;
+    record.child_length = edges[i].first->size();
+    record.is_static = timeline.is_static;
+    record.num_samples = timeline.size();
+    record.stamps_offset = align8(record.child_offset + record.child_length);
+    record.positions_offset = record.stamps_offset + 8 * timeline.size();
+    record.rotations_offset = record.positions_offset + 24 * timeline.size();
+    offset = align8(record.rotations_offset + 16 * timeline.size());
+  }
+
+  IndexHeader header;
+  std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+  header.version = kIndexVersion;
+  header.static_only = key.static_only;
+  header.source_size = key.source_size;
+  header.source_mtime_ns = key.source_mtime_ns;
+  header.num_edges = records.size();
+  header.file_size = offset;
+
+  std::string buffer(offset, '\0');
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  std::memcpy(buffer.data() + sizeof(header),
+              records.data(),
+              records.size() * sizeof(IndexEdge));
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const auto& record = records[i];
+    const auto& timeline = edges[i].second->timeline;
+    auto* data = buffer.data();
+    std::memcpy(data + record.parent_offset,
+                edges[i].second->parent.data(),
+                record.parent_length);
+    std::memcpy(
+        data + record.child_offset, edges[i].first->data(), record.child_length);
+    std::memcpy(data + record.stamps_offset, timeline.stamp_data, 8 * timeline.size());
+    std::memcpy(
+        data + record.positions_offset, timeline.position_data, 24 * timeline.size());
+    std::memcpy(
+        data + record.rotations_offset, timeline.rotation_data, 16 * timeline.size());
+  }
+
+  // written to a temporary file first so that readers never see a partial index (the
+  // name is unique so that concurrent readers of the same bag can't clobber it)
+  auto tmp_path = path;
+  tmp_path += "." + std::to_string(getpid()) + "." +
+              std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+              ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(buffer.data(), buffer.size());
+    if (!out) {
+      std::error_code ec;
+      std::filesystem::remove(tmp_path, ec);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+    return false;
+  }
+
+  return true;
+}
+
+std::shared_ptr<PoseTimeline> PoseTimeline::mapIndex(const std::filesystem::path& path,
+                                                     const IndexKey& key) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat info;
+  const auto min_size = static_cast<off_t>(sizeof(IndexHeader));
+  if (::fstat(fd, &info) != 0 || info.st_size < min_size) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  const uint64_t file_size = info.st_size;
+  void* addr = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  auto timeline = std::make_shared<PoseTimeline>();
+  timeline->mapping_.reset(addr, [file_size](void* ptr) { ::munmap(ptr, file_size); });
+
+  const auto* data = static_cast<const char*>(addr);
+  IndexHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+      header.version != kIndexVersion || header.file_size != file_size ||
+      header.static_only != key.static_only || header.source_size != key.source_size ||
+      header.source_mtime_ns != key.source_mtime_ns ||
+      header.num_edges > (file_size - sizeof(header)) / sizeof(IndexEdge)) {
+    VLOG(1) << "Pose index " << path << " is invalid or out of date";
+    return nullptr;
+  }
+
+  const auto* records = reinterpret_cast<const IndexEdge*>(data + sizeof(header));
+  for (uint64_t i = 0; i < header.num_edges; ++i) {
+    const auto& record = records[i];
+    const auto n = record.num_samples;
+    if (!inFile(record.parent_offset, record.parent_length, file_size) ||
+        !inFile(record.child_offset, record.child_length, file_size) ||
+        n == 0 || n > file_size / 48 || record.stamps_offset % 8 ||
+        record.positions_offset % 8 || record.rotations_offset % 4 ||
+        !inFile(record.stamps_offset, 8 * n, file_size) ||
+        !inFile(record.positions_offset, 24 * n, file_size) ||
+        !inFile(record.rotations_offset, 16 * n, file_size)) {
+      LOG(WARNING) << "Pose index " << path << " is corrupt";
+      return nullptr;
+    }
+
+    const std::string parent(data + record.parent_offset, record.parent_length);
+    const std::string child(data + record.child_offset, record.child_length);
+    auto& edge = timeline->edges_[child];
+    edge.parent = parent;
+    edge.timeline.is_static = record.is_static;
+    edge.timeline.num_samples = n;
+    edge.timeline.stamp_data =
+        reinterpret_cast<const uint64_t*>(data + record.stamps_offset);
+    edge.timeline.position_data =
+        reinterpret_cast<const double*>(data + record.positions_offset);
+    edge.timeline.rotation_data =
+        reinterpret_cast<const float*>(data + record.rotations_offset);
+    timeline->frames_.insert(parent);
+    timeline->frames_.insert(child);
+  }
+
+  return timeline;
+}
+
+std::ostream& operator<<(std::ostream& out, PoseTimeline::Status status) {
+  switch (status) {
+    case PoseTimeline::Status::VALID:
+      return out << "valid";
+    case PoseTimeline::Status::UNKNOWN_FRAME:
+      return out << "unknown frame";
+    case PoseTimeline::Status::NOT_CONNECTED:
+      return out << "frames not connected";
+    case PoseTimeline::Status::EXTRAPOLATION:
+      return out << "extrapolation";
+    default:
+      return out << "unknown status";
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,127 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/shared_image.h"
+
+namespace hydra {
+
+namespace {
+
+using Owner = std::shared_ptr<const void>;
+
+/**
+ * @brief Allocator that releases a reference to an owner instead of freeing memory
+ *
+ * Fresh allocations (e.g., if a shared image is later resized via create) are handed
+ * off to the default OpenCV allocator.
+ */
+class SharedBufferAllocator : public cv::MatAllocator {
+ public:
+  cv::UMatData* allocate(int dims,
+                         const int* sizes,
+                         int type,
+                         void* data,
+                         size_t* step,
+                         cv::AccessFlag flags,
+                         cv::UMatUsageFlags usage_flags) const override {
+    return cv::Mat::getStdAllocator()->allocate(
+        dims, sizes, type, data, step, flags, usage_flags);
+  }
+
+  bool allocate(cv::UMatData* data,
+                cv::AccessFlag,
+                cv::UMatUsageFlags) const override {
+    return data != nullptr;
+  }
+
+  void deallocate(cv::UMatData* data) const override {
+    if (!data) {
+      return;
+    }
+
+    delete static_cast<Owner*>(data->userdata);
+    data->userdata = nullptr;
+    delete data;
+  }
+
+  static const SharedBufferAllocator* instance() {
+    static const SharedBufferAllocator allocator;
+    return &allocator;
+  }
+};
+
+}  // namespace
+
+cv::Mat shareImage(const cv::Mat& view, const Owner& owner) {
+  if (view.empty() || view.u || !owner) {
+    return view;
+  }
+
+  const auto allocator = SharedBufferAllocator::instance();
+  auto data = new cv::UMatData(allocator);
+  data->data = data->origdata = const_cast<uchar*>(view.datastart);
+  data->size = view.dataend - view.datastart;
+  data->flags = cv::UMatData::USER_ALLOCATED;
+  data->userdata = new Owner(owner);
+  data->refcount = 1;
+
+  cv::Mat shared = view;
+  shared.allocator = allocator;
+  shared.u = data;
+  return shared;
+}
+
+ImageView viewImage(const sensor_msgs::Image::ConstPtr& msg,
+                    const std::string& encoding) {
+  ImageView view;
+  if (!msg) {
+    return view;
+  }
+
+  const auto cv_image = encoding.empty() ? cv_bridge::toCvShare(msg)
+                                         : cv_bridge::toCvShare(msg, encoding);
+  const auto& image = cv_image->image;
+  if (!image.empty() && image.data != msg->data.data()) {
+    // cv_bridge had to convert the image, so we already own a copy
+    view.image = image;
+    view.bytes_copied = image.total() * image.elemSize();
+    return view;
+  }
+
+  // the message is kept alive by the cv image (via the captured message pointer)
+  view.image = shareImage(image, Owner(cv_image.get(), [cv_image](const void*) {}));
+  return view;
+}
+
+}  // namespace hydra
@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/static_tf_cache.h"
+
+#include <glog/logging.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <chrono>
+
+namespace hydra {
+
+using sensor_msgs::CameraInfo;
+
+StaticTfCache::BagContents::BagContents(const rosbag::Bag& bag) : poses(bag, true) {
+  const std::string info_type = ros::message_traits::datatype<CameraInfo>();
+  rosbag::View info_view(bag, rosbag::TypeQuery(info_type));
+  for (const auto connection : info_view.getConnections()) {
+    if (camera_info.count(connection->topic)) {
+      continue;
+    }
+
+    // only the first message of each topic is needed
+    rosbag::View topic_view(bag, rosbag::TopicQuery(connection->topic));
+    for (const auto& m : topic_view) {
+      const auto msg = m.instantiate<CameraInfo>();
+      if (msg) {
+        camera_info[connection->topic] = msg;
+        break;
+      }
+    }
+  }
+}
+
+StaticTfCache& StaticTfCache::instance() {
+  static StaticTfCache cache;
+  return cache;
+}
+
+const tf2_ros::Buffer& StaticTfCache::liveBuffer() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!buffer_) {
+    buffer_ = std::make_unique<tf2_ros::Buffer>();
+    listener_ = std::make_unique<tf2_ros::TransformListener>(*buffer_);
+  }
+
+  return *buffer_;
+}
+
+std::shared_ptr<const StaticTfCache::BagContents> StaticTfCache::loadBag(
+    const std::filesystem::path& bag_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto key = std::filesystem::absolute(bag_path).lexically_normal().string();
+  auto iter = bags_.find(key);
+  if (iter != bags_.end()) {
+    return iter->second;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  auto contents = std::make_shared<const BagContents>(bag);
+  bag.close();
+
+  const auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = end - start;
+  LOG(INFO) << "Loaded static transforms and " << contents->camera_info.size()
+            << " camera info topic(s) from " << bag_path << " in " << elapsed.count()
+            << " [s]";
+  bags_.emplace(key, contents);
+  return contents;
+}
+
+void StaticTfCache::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  listener_.reset();
+  buffer_.reset();
+  bags_.clear();
+}
+
+}  // namespace hydra
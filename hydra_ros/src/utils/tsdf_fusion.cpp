@@ -0,0 +1,79 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/tsdf_fusion.h"
+
+#include <glog/logging.h>
+
+#include <vector>
+
+#include "hydra_ros/utils/worker_pool.h"
+
+namespace hydra {
+
+size_t fuseTsdfLayers(const TsdfLayer& from,
+                      TsdfLayer& into,
+                      float max_weight,
+                      WorkerPool* pool) {
+  CHECK_EQ(from.voxel_size, into.voxel_size) << "TSDF layers must match";
+  CHECK_EQ(from.voxels_per_side, into.voxels_per_side) << "TSDF layers must match";
+
+  // allocation modifies the block map and is not thread safe
+  std::vector<std::pair<const TsdfBlock*, TsdfBlock*>> pairs;
+  for (const auto& block : from) {
+    pairs.emplace_back(&block, into.allocateBlockPtr(block.index).get());
+  }
+
+  const auto fuse_blocks = [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      const auto& [source, target] = pairs[i];
+      for (size_t v = 0; v < source->numVoxels(); ++v) {
+        fuseTsdfVoxel(source->getVoxel(v), target->getVoxel(v), max_weight);
+      }
+
+      // fused voxels changed, so the block has to be meshed again
+      target->updated = true;
+    }
+  };
+
+  if (pool) {
+    pool->parallelFor(pairs.size(), fuse_blocks);
+  } else {
+    fuse_blocks(0, pairs.size());
+  }
+
+  return pairs.size();
+}
+
+}  // namespace hydra
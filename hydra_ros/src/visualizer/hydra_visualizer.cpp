@@ -75,7 +75,7 @@ HydraVisualizer::HydraVisualizer(const ros::NodeHandle& nh) : nh_(nh) {
   if (!config_.output_path.empty()) {
     size_log_file_.reset(
         new std::ofstream(config_.output_path + "/dsg_message_sizes.csv"));
-    *size_log_file_ << "time_ns,bytes" << std::endl;
+    *size_log_file_ << "time_ns,bytes,uncompressed_bytes" << std::endl;
   }
 }
 
@@ -112,11 +112,13 @@ bool HydraVisualizer::handleRedraw(std_srvs::Empty::Request&,
 }
 
 void HydraVisualizer::spinRos() {
-  receiver_.reset(new DsgReceiver(nh_, [&](const ros::Time& stamp, size_t bytes) {
-    if (size_log_file_) {
-      *size_log_file_ << stamp.toNSec() << "," << bytes << std::endl;
-    }
-  }));
+  receiver_.reset(new DsgReceiver(
+      nh_, [&](const ros::Time& stamp, size_t bytes, size_t uncompressed_bytes) {
+        if (size_log_file_) {
+          *size_log_file_ << stamp.toNSec() << "," << bytes << "," << uncompressed_bytes
+                          << std::endl;
+        }
+      }));
 
   bool graph_set = false;
 
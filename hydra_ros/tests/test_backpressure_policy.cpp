@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/backpressure_policy.h>
+
+namespace hydra {
+
+namespace {
+
+BackpressurePolicy::Config makeConfig(const std::string& mode,
+                                      size_t max_queue_depth,
+                                      size_t keep_every_n = 2) {
+  BackpressurePolicy::Config config;
+  config.mode = mode;
+  config.max_queue_depth = max_queue_depth;
+  config.keep_every_n = keep_every_n;
+  return config;
+}
+
+}  // namespace
+
+TEST(BackpressurePolicy, KeepsEverythingUnderLimit) {
+  BackpressurePolicy policy(makeConfig("drop", 4));
+  for (size_t i = 0; i < 10; ++i) {
+    const auto decision = policy.update(2, 2);
+    EXPECT_TRUE(decision.keep);
+    EXPECT_FALSE(decision.clear_queue);
+  }
+
+  EXPECT_EQ(policy.numReceived(), 10u);
+  EXPECT_EQ(policy.numDropped(), 0u);
+}
+
+TEST(BackpressurePolicy, NoneIgnoresDepth) {
+  BackpressurePolicy policy(makeConfig("none", 0));
+  EXPECT_TRUE(policy.update(100, 100).keep);
+  EXPECT_EQ(policy.numDropped(), 0u);
+}
+
+TEST(BackpressurePolicy, DropOverLimit) {
+  BackpressurePolicy policy(makeConfig("drop", 4));
+  EXPECT_FALSE(policy.update(0, 5).keep);
+  EXPECT_FALSE(policy.update(3, 2).keep);
+  EXPECT_TRUE(policy.update(0, 4).keep);
+  EXPECT_EQ(policy.numDropped(), 2u);
+}
+
+TEST(BackpressurePolicy, KeepLatestClearsReceiverQueue) {
+  BackpressurePolicy policy(makeConfig("keep_latest", 1));
+  const auto decision = policy.update(3, 1);
+  EXPECT_TRUE(decision.keep);
+  EXPECT_TRUE(decision.clear_queue);
+  EXPECT_EQ(policy.numDropped(), 3u);
+
+  // nothing to clear when only reconstruction is behind
+  EXPECT_FALSE(policy.update(0, 5).clear_queue);
+}
+
+TEST(BackpressurePolicy, KeepEveryNth) {
+  BackpressurePolicy policy(makeConfig("keep_every_nth", 0, 3));
+  size_t num_kept = 0;
+  for (size_t i = 0; i < 9; ++i) {
+    num_kept += policy.update(1, 0).keep ? 1 : 0;
+  }
+
+  EXPECT_EQ(num_kept, 3u);
+  EXPECT_EQ(policy.numDropped(), 6u);
+}
+
+}  // namespace hydra
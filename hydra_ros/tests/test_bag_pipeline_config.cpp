@@ -0,0 +1,79 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/hydra_bag_pipeline.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace hydra {
+
+namespace {
+
+void writeFile(const std::filesystem::path& path, const std::string& contents) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream out(path);
+  out << contents;
+}
+
+}  // namespace
+
+TEST(HydraBagPipeline, LoadConfigWithIncludes) {
+  const auto root = std::filesystem::temp_directory_path() / "hydra_ros_test_offline";
+  std::filesystem::remove_all(root);
+  writeFile(root / "modules" / "frontend.yaml",
+            "type: FrontendModule\n"
+            "objects: {min_cluster_size: 10, max_cluster_size: 100}\n");
+  writeFile(root / "common.yaml", "robot_frame: base_link\nodom_frame: odom\n");
+  writeFile(root / "offline" / "config.yaml",
+            "include:\n"
+            "  - {path: " + (root / "common.yaml").string() + "}\n"
+            "  - {path: ../modules/frontend.yaml, ns: frontend}\n"
+            "odom_frame: world\n"
+            "frontend:\n"
+            "  objects: {min_cluster_size: 20}\n");
+
+  const auto config = loadBagPipelineConfig(root / "offline" / "config.yaml");
+  EXPECT_FALSE(config["include"]);
+  EXPECT_EQ(config["robot_frame"].as<std::string>(), "base_link");
+  // values in the including file take precedence
+  EXPECT_EQ(config["odom_frame"].as<std::string>(), "world");
+  EXPECT_EQ(config["frontend"]["type"].as<std::string>(), "FrontendModule");
+  EXPECT_EQ(config["frontend"]["objects"]["min_cluster_size"].as<int>(), 20);
+  EXPECT_EQ(config["frontend"]["objects"]["max_cluster_size"].as<int>(), 100);
+  std::filesystem::remove_all(root);
+}
+
+}  // namespace hydra
@@ -0,0 +1,171 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/camera_info_prefetcher.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace hydra {
+
+namespace {
+
+std::filesystem::path tempCachePath(const std::string& name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path;
+}
+
+sensor_msgs::CameraInfo makeInfo(uint32_t width, uint32_t height) {
+  sensor_msgs::CameraInfo msg;
+  msg.header.frame_id = "camera";
+  msg.width = width;
+  msg.height = height;
+  msg.distortion_model = "plumb_bob";
+  msg.D = {0.1, -0.2, 0.0, 0.0, 0.05};
+  msg.K = {500.0, 0.0, 320.0, 0.0, 510.0, 240.0, 0.0, 0.0, 1.0};
+  return msg;
+}
+
+XmlRpc::XmlRpcValue makeSensor(const std::string& type, const std::string& topic) {
+  XmlRpc::XmlRpcValue sensor;
+  sensor["type"] = type;
+  sensor["camera_info_topic"] = topic;
+  return sensor;
+}
+
+}  // namespace
+
+TEST(CameraInfoCache, RoundTrip) {
+  const auto path = tempCachePath("hydra_ros_test_camera_info_round_trip.yaml");
+  const auto left = makeInfo(640, 480);
+  auto right = makeInfo(320, 240);
+  right.K[0] = 250.0;
+  EXPECT_TRUE(writeCachedCameraInfo(path, "/left/camera_info", left));
+  EXPECT_TRUE(writeCachedCameraInfo(path, "/right/camera_info", right));
+
+  const auto result = readCachedCameraInfo(path, "/left/camera_info");
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->header.frame_id, left.header.frame_id);
+  EXPECT_EQ(result->width, left.width);
+  EXPECT_EQ(result->height, left.height);
+  EXPECT_EQ(result->distortion_model, left.distortion_model);
+  EXPECT_EQ(result->D, left.D);
+  EXPECT_EQ(result->K, left.K);
+
+  // writing a second topic keeps the first one
+  const auto other = readCachedCameraInfo(path, "/right/camera_info");
+  ASSERT_TRUE(other);
+  EXPECT_EQ(other->width, 320u);
+  EXPECT_EQ(other->K, right.K);
+  std::filesystem::remove(path);
+}
+
+TEST(CameraInfoCache, RejectsMissingOrInvalidEntries) {
+  const auto path = tempCachePath("hydra_ros_test_camera_info_invalid.yaml");
+  EXPECT_FALSE(readCachedCameraInfo(path, "/camera_info"));
+
+  {  // scope for file
+    std::ofstream out(path);
+    out << "/invalid:\n"
+        << "  valid: false\n"
+        << "  width: 640\n"
+        << "  height: 480\n"
+        << "  K: [1, 0, 0, 0, 1, 0, 0, 0, 1]\n"
+        << "/short:\n"
+        << "  valid: true\n"
+        << "  width: 640\n"
+        << "  height: 480\n"
+        << "  K: [1, 0, 0]\n";
+  }
+
+  EXPECT_FALSE(readCachedCameraInfo(path, "/camera_info"));
+  EXPECT_FALSE(readCachedCameraInfo(path, "/invalid"));
+  EXPECT_FALSE(readCachedCameraInfo(path, "/short"));
+
+  // an unparseable cache is overwritten
+  {  // scope for file
+    std::ofstream out(path);
+    out << "{[: not yaml";
+  }
+
+  EXPECT_FALSE(readCachedCameraInfo(path, "/camera_info"));
+  EXPECT_TRUE(writeCachedCameraInfo(path, "/camera_info", makeInfo(640, 480)));
+  EXPECT_TRUE(readCachedCameraInfo(path, "/camera_info"));
+  std::filesystem::remove(path);
+}
+
+TEST(CameraInfoPrefetcher, FindsCameraInfoTopics) {
+  ros::NodeHandle nh("~find_camera_info_topics");
+  XmlRpc::XmlRpcValue sensors;
+  sensors[0] = makeSensor("camera_info", "left/camera_info");
+  sensors[1] = makeSensor("rosbag_camera_info", "bag/camera_info");
+  XmlRpc::XmlRpcValue nested;
+  nested["sensor"]["intrinsics"] = makeSensor("camera_info", "right/camera_info");
+  sensors[2] = nested;
+  nh.setParam("input/sensors", sensors);
+  nh.setParam("other/type", "camera_info");
+
+  auto topics = findCameraInfoTopics(nh);
+  std::sort(topics.begin(), topics.end());
+  const std::vector<std::string> expected{"left/camera_info", "right/camera_info"};
+  EXPECT_EQ(topics, expected);
+
+  nh.deleteParam(nh.getNamespace());
+  ros::NodeHandle empty("~no_camera_info_topics");
+  EXPECT_TRUE(findCameraInfoTopics(empty).empty());
+}
+
+TEST(CameraInfoPrefetcher, FindsSensorFrames) {
+  ros::NodeHandle nh("~find_sensor_frames");
+  XmlRpc::XmlRpcValue sensors;
+  sensors[0]["extrinsics"]["type"] = "ros";
+  sensors[0]["extrinsics"]["sensor_frame"] = "left_camera";
+  sensors[1]["extrinsics"]["type"] = "rosbag";
+  sensors[1]["extrinsics"]["sensor_frame"] = "bag_camera";
+  sensors[2]["extrinsics"]["type"] = "ros";
+  sensors[2]["extrinsics"]["sensor_frame"] = "right_camera";
+  nh.setParam("input/sensors", sensors);
+
+  auto frames = findSensorFrames(nh);
+  std::sort(frames.begin(), frames.end());
+  const std::vector<std::string> expected{"left_camera", "right_camera"};
+  EXPECT_EQ(frames, expected);
+  nh.deleteParam(nh.getNamespace());
+}
+
+}  // namespace hydra
@@ -0,0 +1,130 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/decode_stage.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+TEST(DecodeStage, DeliversInTimestampOrder) {
+  DecodeStage::Config config;
+  config.num_threads = 4;
+  config.max_pending = 16;
+  DecodeStage stage(config);
+
+  std::vector<uint64_t> delivered;
+  for (uint64_t i = 0; i < 32; ++i) {
+    stage.submit(i, [i, &delivered]() -> DecodeStage::Continuation {
+      // earlier tasks take longer so they finish out of order
+      std::this_thread::sleep_for(std::chrono::microseconds((32 - i) * 50));
+      return [i, &delivered]() { delivered.push_back(i); };
+    });
+  }
+
+  stage.flush();
+  ASSERT_EQ(delivered.size(), 32u);
+  for (uint64_t i = 0; i < delivered.size(); ++i) {
+    EXPECT_EQ(delivered[i], i);
+  }
+
+  EXPECT_EQ(stage.numPending(), 0u);
+}
+
+TEST(DecodeStage, FailedTasksDoNotBlockLaterResults) {
+  DecodeStage::Config config;
+  config.num_threads = 2;
+  DecodeStage stage(config);
+
+  std::vector<uint64_t> delivered;
+  stage.submit(1, []() -> DecodeStage::Continuation {
+    throw std::runtime_error("bad image");
+  });
+  stage.submit(2, []() -> DecodeStage::Continuation { return nullptr; });
+  stage.submit(3, [&delivered]() -> DecodeStage::Continuation {
+    return [&delivered]() { delivered.push_back(3); };
+  });
+
+  stage.flush();
+  EXPECT_EQ(delivered, std::vector<uint64_t>{3});
+}
+
+TEST(DecodeStage, BoundsPendingTasks) {
+  DecodeStage::Config config;
+  config.num_threads = 1;
+  config.max_pending = 2;
+  DecodeStage stage(config);
+
+  size_t max_pending = 0;
+  for (uint64_t i = 0; i < 8; ++i) {
+    stage.submit(i, []() -> DecodeStage::Continuation {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      return nullptr;
+    });
+    max_pending = std::max(max_pending, stage.numPending());
+  }
+
+  stage.flush();
+  EXPECT_LE(max_pending, 2u);
+}
+
+TEST(DecodeStage, ReportsStats) {
+  DecodeStage::Config config;
+  config.num_threads = 2;
+  DecodeStage stage(config);
+
+  size_t num_delivered = 0;
+  for (uint64_t i = 0; i < 6; ++i) {
+    stage.submit(i, [i, &num_delivered]() -> DecodeStage::Continuation {
+      if (i % 2) {
+        return nullptr;
+      }
+
+      return [&num_delivered]() { ++num_delivered; };
+    });
+  }
+
+  stage.flush();
+  const auto stats = stage.stats();
+  EXPECT_EQ(stats.num_tasks, 6u);
+  EXPECT_EQ(stats.num_delivered, 3u);
+  EXPECT_EQ(num_delivered, 3u);
+  EXPECT_GE(stats.task_s, 0.0);
+  EXPECT_GE(stats.delivery_s, 0.0);
+}
+
+}  // namespace hydra
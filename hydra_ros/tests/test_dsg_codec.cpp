@@ -0,0 +1,99 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_codec.h>
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace hydra {
+
+TEST(DsgCodec, ParsesNames) {
+  EXPECT_EQ(parseDsgCodec("none"), DsgCodec::NONE);
+  EXPECT_EQ(parseDsgCodec("zstd"), DsgCodec::ZSTD);
+  EXPECT_EQ(parseDsgCodec("lz4"), DsgCodec::LZ4);
+  EXPECT_EQ(parseDsgCodec("gzip"), DsgCodec::NONE);
+  EXPECT_EQ(toString(DsgCodec::ZSTD), "zstd");
+  EXPECT_TRUE(hasDsgCodec(DsgCodec::NONE));
+  // lz4 defaults to the fast compressor
+  EXPECT_EQ(defaultDsgCompressionLevel(DsgCodec::LZ4), 1);
+  EXPECT_EQ(defaultDsgCompressionLevel(DsgCodec::ZSTD), 3);
+}
+
+TEST(DsgCodec, RoundTripsAvailableCodecs) {
+  std::vector<uint8_t> payload(4096);
+  std::iota(payload.begin(), payload.end(), 0);
+
+  // uncompressed payloads are sent as-is
+  std::vector<uint8_t> compressed;
+  EXPECT_FALSE(compressDsg(DsgCodec::NONE, 3, payload, compressed));
+
+  for (const auto codec : {DsgCodec::ZSTD, DsgCodec::LZ4}) {
+    if (!hasDsgCodec(codec)) {
+      continue;
+    }
+
+    ASSERT_TRUE(compressDsg(codec, 3, payload, compressed)) << toString(codec);
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(decompressDsg(codec, compressed, payload.size(), result));
+    EXPECT_EQ(result, payload) << toString(codec);
+
+    // a wrong size indicates a corrupt or truncated payload
+    EXPECT_FALSE(decompressDsg(codec, compressed, payload.size() + 1, result));
+  }
+}
+
+TEST(DsgCodec, RejectsCorruptSizes) {
+  std::vector<uint8_t> payload(4096, 7);
+  for (const auto codec : {DsgCodec::ZSTD, DsgCodec::LZ4}) {
+    if (!hasDsgCodec(codec)) {
+      continue;
+    }
+
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE(compressDsg(codec, 1, payload, compressed)) << toString(codec);
+
+    // sizes are checked before allocating the output
+    std::vector<uint8_t> result;
+    const auto huge = std::numeric_limits<uint64_t>::max();
+    EXPECT_FALSE(decompressDsg(codec, compressed, huge, result)) << toString(codec);
+    EXPECT_TRUE(result.empty());
+    EXPECT_FALSE(decompressDsg(codec, compressed, kMaxDsgPayloadSize, result));
+    EXPECT_TRUE(result.empty());
+  }
+}
+
+}  // namespace hydra
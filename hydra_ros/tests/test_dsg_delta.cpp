@@ -0,0 +1,169 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_delta.h>
+
+#include <chrono>
+
+namespace hydra {
+
+namespace {
+
+NodeAttributes::Ptr makeAttrs(double x) {
+  return std::make_unique<NodeAttributes>(Eigen::Vector3d(x, 0.0, 0.0));
+}
+
+}  // namespace
+
+TEST(DsgDelta, OnlyContainsChanges) {
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 10; ++i) {
+    graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), makeAttrs(i));
+  }
+  graph.insertEdge(NodeSymbol('p', 0), NodeSymbol('p', 1));
+
+  DsgDeltaTracker tracker;
+  tracker.reset(graph);
+  auto received = graph.clone();
+
+  // one changed node, one new node with an edge and one removed node
+  graph.addOrUpdateNode(DsgLayers::PLACES, NodeSymbol('p', 2), makeAttrs(20.0));
+  graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', 10), makeAttrs(10.0));
+  graph.insertEdge(NodeSymbol('p', 9), NodeSymbol('p', 10));
+  graph.removeNode(NodeSymbol('p', 0));
+
+  const auto delta = tracker.update(graph);
+  EXPECT_EQ(delta.graph->numNodes(), 3u);
+  EXPECT_EQ(delta.graph->numEdges(), 1u);
+  EXPECT_EQ(delta.deleted_nodes, std::vector<NodeId>{NodeSymbol('p', 0)});
+  ASSERT_EQ(delta.deleted_edges.size(), 1u);
+
+  applyDelta(*received, *delta.graph, delta.deleted_nodes, delta.deleted_edges);
+  EXPECT_EQ(received->numNodes(), graph.numNodes());
+  EXPECT_EQ(received->numEdges(), graph.numEdges());
+  EXPECT_FALSE(received->hasNode(NodeSymbol('p', 0)));
+  EXPECT_TRUE(received->hasEdge(NodeSymbol('p', 9), NodeSymbol('p', 10)));
+  EXPECT_EQ(received->getNode(NodeSymbol('p', 2)).attributes().position.x(), 20.0);
+
+  // nothing changed since the last update
+  const auto empty = tracker.update(graph);
+  EXPECT_EQ(empty.graph->numNodes(), 0u);
+  EXPECT_TRUE(empty.deleted_nodes.empty());
+  EXPECT_TRUE(empty.deleted_edges.empty());
+}
+
+TEST(DsgDelta, OnlyContainsChangedDynamicNodes) {
+  using std::chrono::nanoseconds;
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', 0), makeAttrs(0.0));
+  for (size_t i = 0; i < 5; ++i) {
+    graph.emplaceNode(DsgLayers::AGENTS, 'a', nanoseconds(i), makeAttrs(i));
+  }
+  graph.insertEdge(NodeSymbol('a', 4), NodeSymbol('p', 0));
+
+  DsgDeltaTracker tracker;
+  tracker.reset(graph);
+  auto received = graph.clone();
+
+  // one changed, one appended and one removed agent node
+  graph.addOrUpdateNode(DsgLayers::AGENTS, NodeSymbol('a', 2), makeAttrs(20.0));
+  graph.emplaceNode(DsgLayers::AGENTS, 'a', nanoseconds(5), makeAttrs(5.0));
+  graph.insertEdge(NodeSymbol('a', 5), NodeSymbol('p', 0));
+  graph.removeNode(NodeSymbol('a', 1));
+
+  const auto delta = tracker.update(graph);
+  // the rest of the agent layer is not resent
+  EXPECT_TRUE(delta.graph->hasNode(NodeSymbol('a', 2)));
+  EXPECT_TRUE(delta.graph->hasNode(NodeSymbol('a', 5)));
+  EXPECT_FALSE(delta.graph->hasNode(NodeSymbol('a', 0)));
+  EXPECT_FALSE(delta.graph->hasNode(NodeSymbol('a', 3)));
+  EXPECT_EQ(delta.deleted_nodes, std::vector<NodeId>{NodeSymbol('a', 1)});
+
+  applyDelta(*received, *delta.graph, delta.deleted_nodes, delta.deleted_edges);
+  EXPECT_EQ(received->numNodes(), graph.numNodes());
+  EXPECT_EQ(received->numEdges(), graph.numEdges());
+  EXPECT_FALSE(received->hasNode(NodeSymbol('a', 1)));
+  EXPECT_TRUE(received->hasEdge(NodeSymbol('a', 5), NodeSymbol('p', 0)));
+  EXPECT_EQ(received->getNode(NodeSymbol('a', 2)).attributes().position.x(), 20.0);
+  const auto& appended = received->getNode(NodeSymbol('a', 5));
+  EXPECT_EQ(appended.timestamp.value(), nanoseconds(5));
+  EXPECT_EQ(received->getLayer(DsgLayers::AGENTS, 'a').nodes().size(), 6u);
+}
+
+TEST(DsgSequenceTracker, DropsDeltasAfterGapUntilKeyframe) {
+  using Action = DsgSequenceTracker::Action;
+  DsgSequenceTracker sequence;
+
+  // deltas can't be applied before the first keyframe
+  EXPECT_EQ(sequence.receive(0, false), Action::DROP_AND_REQUEST_KEYFRAME);
+  EXPECT_EQ(sequence.receive(1, false), Action::DROP);
+  EXPECT_EQ(sequence.receive(2, true), Action::APPLY);
+  EXPECT_EQ(sequence.receive(3, false), Action::APPLY);
+
+  // a gap requests a single keyframe and drops every delta until it arrives
+  EXPECT_EQ(sequence.receive(5, false), Action::DROP_AND_REQUEST_KEYFRAME);
+  EXPECT_TRUE(sequence.waitingForKeyframe());
+  EXPECT_EQ(sequence.receive(6, false), Action::DROP);
+  EXPECT_EQ(sequence.receive(7, true), Action::APPLY);
+  EXPECT_FALSE(sequence.waitingForKeyframe());
+  EXPECT_EQ(sequence.receive(8, false), Action::APPLY);
+
+  // as does an update that failed to apply
+  sequence.markFailed();
+  EXPECT_EQ(sequence.receive(9, false), Action::DROP);
+  EXPECT_EQ(sequence.receive(10, true), Action::APPLY);
+}
+
+TEST(DsgDelta, ExtractsLayers) {
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::OBJECTS, NodeSymbol('O', 0), makeAttrs(0.0));
+  graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', 0), makeAttrs(1.0));
+  graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', 1), makeAttrs(2.0));
+  graph.emplaceNode(DsgLayers::ROOMS, NodeSymbol('R', 0), makeAttrs(3.0));
+  graph.insertEdge(NodeSymbol('p', 0), NodeSymbol('p', 1));
+  graph.insertEdge(NodeSymbol('O', 0), NodeSymbol('p', 0));
+  graph.insertEdge(NodeSymbol('R', 0), NodeSymbol('O', 0));
+
+  const auto result = extractLayers(graph, {DsgLayers::OBJECTS, DsgLayers::ROOMS});
+  EXPECT_EQ(result->numNodes(), 2u);
+  EXPECT_TRUE(result->hasNode(NodeSymbol('O', 0)));
+  EXPECT_TRUE(result->hasNode(NodeSymbol('R', 0)));
+  EXPECT_FALSE(result->hasNode(NodeSymbol('p', 0)));
+  // only the edge between selected layers is kept
+  EXPECT_EQ(result->numEdges(), 1u);
+  EXPECT_TRUE(result->hasEdge(NodeSymbol('R', 0), NodeSymbol('O', 0)));
+}
+
+}  // namespace hydra
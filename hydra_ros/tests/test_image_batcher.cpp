@@ -0,0 +1,166 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/image_batcher.h>
+
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+constexpr uint64_t kMsNs = 1000000;
+
+struct BatchLog {
+  ImageBatcher::Sink sink(size_t camera) {
+    return [this, camera](const InputPacket::Ptr& packet) {
+      entries.emplace_back(camera, packet->timestamp_ns);
+    };
+  }
+
+  std::vector<std::pair<size_t, uint64_t>> entries;
+};
+
+InputPacket::Ptr makePacket(uint64_t timestamp_ns) {
+  return std::make_shared<CloudInputPacket>(timestamp_ns, 0);
+}
+
+}  // namespace
+
+TEST(ImageBatcher, EmitsCompleteBatchInSlotOrder) {
+  ImageBatcher batcher(0.01);
+  BatchLog log;
+  for (size_t i = 0; i < 3; ++i) {
+    batcher.addCamera(log.sink(i));
+  }
+
+  batcher.submit(1, makePacket(100 * kMsNs));
+  batcher.submit(0, makePacket(102 * kMsNs));
+  EXPECT_TRUE(log.entries.empty());
+
+  batcher.submit(2, makePacket(105 * kMsNs));
+  std::vector<std::pair<size_t, uint64_t>> expected{
+      {0, 102 * kMsNs}, {1, 100 * kMsNs}, {2, 105 * kMsNs}};
+  EXPECT_EQ(log.entries, expected);
+  EXPECT_EQ(batcher.numBatches(), 1u);
+  EXPECT_EQ(batcher.numSkipped(), 0u);
+}
+
+TEST(ImageBatcher, SkipsCamerasOutsideWindow) {
+  ImageBatcher batcher(0.01);
+  BatchLog log;
+  for (size_t i = 0; i < 3; ++i) {
+    batcher.addCamera(log.sink(i));
+  }
+
+  batcher.submit(0, makePacket(200 * kMsNs));
+  batcher.submit(1, makePacket(201 * kMsNs));
+  // a packet outside the window closes the current batch
+  batcher.submit(0, makePacket(300 * kMsNs));
+  std::vector<std::pair<size_t, uint64_t>> expected{{0, 200 * kMsNs},
+                                                    {1, 201 * kMsNs}};
+  EXPECT_EQ(log.entries, expected);
+  EXPECT_EQ(batcher.numSkipped(), 1u);
+
+  // packets for batches that were already emitted are dropped
+  batcher.submit(2, makePacket(199 * kMsNs));
+  EXPECT_EQ(batcher.numDropped(), 1u);
+
+  batcher.flush();
+  EXPECT_EQ(log.entries.size(), 3u);
+  EXPECT_EQ(batcher.numBatches(), 2u);
+}
+
+TEST(ImageBatcher, RepeatedCameraClosesBatch) {
+  ImageBatcher batcher(0.05);
+  BatchLog log;
+  batcher.addCamera(log.sink(0));
+  batcher.addCamera(log.sink(1));
+
+  batcher.submit(0, makePacket(100 * kMsNs));
+  batcher.submit(0, makePacket(110 * kMsNs));
+  EXPECT_EQ(log.entries.size(), 1u);
+  EXPECT_EQ(batcher.numSkipped(), 1u);
+}
+
+TEST(ImageBatcher, RemovedCamerasAreIgnored) {
+  ImageBatcher batcher(0.01);
+  BatchLog log;
+  batcher.addCamera(log.sink(0));
+  const auto slot = batcher.addCamera(log.sink(1));
+  batcher.removeCamera(slot);
+  EXPECT_EQ(batcher.numCameras(), 1u);
+
+  batcher.submit(slot, makePacket(100 * kMsNs));
+  EXPECT_TRUE(log.entries.empty());
+
+  // the remaining camera completes batches on its own
+  batcher.submit(0, makePacket(100 * kMsNs));
+  EXPECT_EQ(log.entries.size(), 1u);
+}
+
+TEST(ImageBatcher, GroupsAreShared) {
+  auto first = ImageBatcher::getGroup("test_group", 0.02);
+  auto second = ImageBatcher::getGroup("test_group", 0.02);
+  auto other = ImageBatcher::getGroup("other_group", 0.02);
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+}
+
+TEST(ImageBatcher, PacketsShareBatchId) {
+  ImageBatcher batcher(0.01);
+  BatchLog log;
+  batcher.addCamera(log.sink(0));
+  batcher.addCamera(log.sink(1));
+
+  EXPECT_FALSE(ImageBatcher::findBatch(5000 * kMsNs));
+  batcher.submit(0, makePacket(5000 * kMsNs));
+  // packets are only indexed once their batch is emitted
+  EXPECT_FALSE(ImageBatcher::findBatch(5000 * kMsNs));
+  batcher.submit(1, makePacket(5004 * kMsNs));
+  batcher.submit(0, makePacket(5008 * kMsNs));
+  batcher.submit(1, makePacket(5009 * kMsNs));
+
+  // consecutive frames of one camera are within the window but not in one batch
+  const auto first = ImageBatcher::findBatch(5000 * kMsNs);
+  const auto second = ImageBatcher::findBatch(5008 * kMsNs);
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_EQ(ImageBatcher::findBatch(5004 * kMsNs), first);
+  EXPECT_EQ(ImageBatcher::findBatch(5009 * kMsNs), second);
+  EXPECT_NE(*first, *second);
+}
+
+}  // namespace hydra
@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/image_decimator.h>
+
+namespace hydra {
+
+namespace {
+
+Camera::Config makeCameraConfig(int width, int height) {
+  Camera::Config config;
+  config.width = width;
+  config.height = height;
+  config.fx = 500.0;
+  config.fy = 510.0;
+  config.cx = width / 2.0;
+  config.cy = height / 2.0;
+  return config;
+}
+
+}  // namespace
+
+TEST(ImageDecimator, IntrinsicsMatchDecimatedImages) {
+  ImageDecimator::Config config;
+  config.stride = 3;
+  config.roi_x = 10;
+  config.roi_y = 5;
+  config.roi_height = 400;
+  const ImageDecimator decimator(config);
+
+  // every pixel stores its column in the original image
+  cv::Mat image(480, 640, CV_16UC1);
+  for (int r = 0; r < image.rows; ++r) {
+    for (int c = 0; c < image.cols; ++c) {
+      image.at<uint16_t>(r, c) = c;
+    }
+  }
+
+  const auto original = makeCameraConfig(image.cols, image.rows);
+  auto scaled = original;
+  decimator.scaleIntrinsics(scaled);
+
+  for (const auto& result : {decimator.nearest(image), decimator.depth(image)}) {
+    EXPECT_EQ(static_cast<int>(scaled.width), result.cols);
+    EXPECT_EQ(static_cast<int>(scaled.height), result.rows);
+
+    // pixels of the decimated image project to the same rays as the original pixel
+    for (int c = 0; c < result.cols; c += 17) {
+      const int u = result.at<uint16_t>(0, c);
+      EXPECT_EQ(u, config.roi_x + config.stride * c);
+      EXPECT_NEAR(
+          (c - scaled.cx) / scaled.fx, (u - original.cx) / original.fx, 1.0e-5);
+    }
+  }
+
+  const double v = config.roi_y + config.stride * 7;
+  EXPECT_NEAR((7 - scaled.cy) / scaled.fy, (v - original.cy) / original.fy, 1.0e-5);
+}
+
+TEST(ImageDecimator, DisabledKeepsIntrinsics) {
+  const ImageDecimator decimator(ImageDecimator::Config{});
+  auto config = makeCameraConfig(640, 480);
+  decimator.scaleIntrinsics(config);
+  EXPECT_EQ(static_cast<int>(config.width), 640);
+  EXPECT_EQ(static_cast<int>(config.height), 480);
+  EXPECT_EQ(config.cx, 320.0);
+  EXPECT_EQ(config.fx, 500.0);
+}
+
+}  // namespace hydra
@@ -0,0 +1,89 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/latest_mailbox.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+TEST(LatestMailbox, CoalescesUntakenValues) {
+  LatestMailbox<int> mailbox;
+  EXPECT_FALSE(mailbox.put(1));
+  EXPECT_TRUE(mailbox.put(2));
+  EXPECT_TRUE(mailbox.put(3));
+  EXPECT_EQ(mailbox.numCoalesced(), 2u);
+  EXPECT_EQ(mailbox.take(), 3);
+
+  // a taken value is never counted
+  EXPECT_FALSE(mailbox.put(4));
+  EXPECT_EQ(mailbox.take(), 4);
+  EXPECT_EQ(mailbox.numCoalesced(), 2u);
+}
+
+TEST(LatestMailbox, DrainsPendingValueOnShutdown) {
+  LatestMailbox<int> mailbox;
+  mailbox.put(1);
+  mailbox.put(2);
+  mailbox.shutdown();
+  EXPECT_EQ(mailbox.take(), 2);
+  EXPECT_FALSE(mailbox.take());
+}
+
+TEST(LatestMailbox, ConsumerSeesLastValueBeforeShutdown) {
+  LatestMailbox<int> mailbox;
+  std::vector<int> taken;
+  std::thread consumer([&]() {
+    while (const auto value = mailbox.take()) {
+      taken.push_back(*value);
+    }
+  });
+
+  for (int i = 0; i < 1000; ++i) {
+    mailbox.put(int(i));
+  }
+
+  mailbox.shutdown();
+  consumer.join();
+  ASSERT_FALSE(taken.empty());
+  EXPECT_EQ(taken.back(), 999);
+  // every value is either taken or coalesced
+  EXPECT_EQ(taken.size() + mailbox.numCoalesced(), 1000u);
+  EXPECT_TRUE(std::is_sorted(taken.begin(), taken.end()));
+}
+
+}  // namespace hydra
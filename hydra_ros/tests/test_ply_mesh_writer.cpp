@@ -0,0 +1,147 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/ply_mesh_writer.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace hydra {
+
+namespace {
+
+spark_dsg::Mesh makeTriangle(const Eigen::Vector3f& p0,
+                             const Eigen::Vector3f& p1,
+                             const Eigen::Vector3f& p2) {
+  spark_dsg::Mesh mesh;
+  mesh.points = {p0, p1, p2};
+  mesh.colors = {spark_dsg::Color(255, 0, 0),
+                 spark_dsg::Color(0, 255, 0),
+                 spark_dsg::Color(0, 0, 255)};
+  mesh.faces = {{0, 1, 2}};
+  return mesh;
+}
+
+struct PlyContents {
+  size_t num_vertices = 0;
+  size_t num_faces = 0;
+  std::vector<std::array<uint32_t, 3>> faces;
+};
+
+PlyContents readPly(const std::filesystem::path& path) {
+  PlyContents contents;
+  std::ifstream in(path, std::ios::binary);
+  std::string line;
+  while (std::getline(in, line) && line != "end_header") {
+    std::stringstream ss(line);
+    std::string keyword, element;
+    ss >> keyword >> element;
+    if (keyword == "element" && element == "vertex") {
+      ss >> contents.num_vertices;
+    } else if (keyword == "element" && element == "face") {
+      ss >> contents.num_faces;
+    }
+  }
+
+  // x, y, z as float and r, g, b as uchar
+  in.seekg(contents.num_vertices * 15, std::ios::cur);
+  for (size_t i = 0; i < contents.num_faces; ++i) {
+    uint8_t count;
+    auto& face = contents.faces.emplace_back();
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    in.read(reinterpret_cast<char*>(face.data()), sizeof(uint32_t) * 3);
+    EXPECT_EQ(count, 3);
+  }
+
+  EXPECT_TRUE(in.good());
+  return contents;
+}
+
+}  // namespace
+
+TEST(PlyMeshWriter, WeldsSharedVerticesAcrossMeshes) {
+  const auto path = std::filesystem::temp_directory_path() / "test_ply_writer.ply";
+  {
+    PlyMeshWriter writer(path);
+    writer.addMesh(makeTriangle({0, 0, 0}, {1, 0, 0}, {0, 1, 0}));
+    // shares an edge with the first triangle (up to float noise)
+    writer.addMesh(makeTriangle({1, 1.0e-6, 0}, {0, 1, 0}, {1, 1, 0}));
+    EXPECT_TRUE(writer.finish());
+    EXPECT_EQ(writer.numVertices(), 4u);
+    EXPECT_EQ(writer.numFaces(), 2u);
+    EXPECT_EQ(writer.numWelded(), 2u);
+  }
+
+  const auto contents = readPly(path);
+  EXPECT_EQ(contents.num_vertices, 4u);
+  ASSERT_EQ(contents.num_faces, 2u);
+  EXPECT_EQ(contents.faces[0], (std::array<uint32_t, 3>{0, 1, 2}));
+  EXPECT_EQ(contents.faces[1], (std::array<uint32_t, 3>{1, 2, 3}));
+  EXPECT_FALSE(std::filesystem::exists(path.string() + ".faces.tmp"));
+  std::filesystem::remove(path);
+}
+
+TEST(PlyMeshWriter, OnlyIndexesBlockBoundariesAcrossMeshes) {
+  const auto path = std::filesystem::temp_directory_path() / "test_ply_blocks.ply";
+  // blocks of 1 m where vertices within 0.1 m of a block face can be shared
+  PlyMeshWriter writer(path, 1.0e-4, 1.0, 0.1);
+  writer.addMesh(makeTriangle({0.5, 0.5, 0.5}, {0.95, 0.5, 0.5}, {0.5, 0.6, 0.5}));
+  // only the vertex next to the face at x = 1 is kept after the first block
+  EXPECT_EQ(writer.numIndexed(), 1u);
+  writer.addMesh(makeTriangle({0.95, 0.5, 0.5}, {1.5, 0.5, 0.5}, {1.5, 0.6, 0.5}));
+  EXPECT_EQ(writer.numWelded(), 1u);
+  // interior vertices are not shared between blocks
+  writer.addMesh(makeTriangle({0.5, 0.5, 0.5}, {0.5, 0.4, 0.5}, {0.4, 0.5, 0.5}));
+  EXPECT_EQ(writer.numWelded(), 1u);
+  EXPECT_EQ(writer.numIndexed(), 1u);
+  EXPECT_TRUE(writer.finish());
+  EXPECT_EQ(writer.numVertices(), 8u);
+  EXPECT_EQ(writer.numFaces(), 3u);
+  std::filesystem::remove(path);
+}
+
+TEST(PlyMeshWriter, DropsFacesCollapsedByWelding) {
+  const auto path = std::filesystem::temp_directory_path() / "test_ply_collapse.ply";
+  PlyMeshWriter writer(path, 0.1);
+  writer.addMesh(makeTriangle({0, 0, 0}, {0.01, 0, 0}, {0, 1, 0}));
+  EXPECT_TRUE(writer.finish());
+  EXPECT_EQ(writer.numVertices(), 2u);
+  EXPECT_EQ(writer.numFaces(), 0u);
+  EXPECT_EQ(readPly(path).num_faces, 0u);
+  std::filesystem::remove(path);
+}
+
+}  // namespace hydra
@@ -0,0 +1,204 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/pointcloud_adaptor.h>
+#include <hydra_ros/utils/worker_pool.h>
+
+#include <cstring>
+
+namespace hydra {
+
+using sensor_msgs::PointField;
+
+namespace {
+
+PointField makeField(const std::string& name, uint32_t offset, uint8_t datatype) {
+  PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  return field;
+}
+
+struct TestCloud {
+  TestCloud(uint32_t height, uint32_t width, uint32_t point_step, uint32_t padding = 0) {
+    msg.height = height;
+    msg.width = width;
+    msg.point_step = point_step;
+    msg.row_step = width * point_step + padding;
+    msg.data.resize(msg.row_step * height);
+    msg.fields.push_back(makeField("x", 0, PointField::FLOAT32));
+    msg.fields.push_back(makeField("y", 4, PointField::FLOAT32));
+    msg.fields.push_back(makeField("z", 8, PointField::FLOAT32));
+  }
+
+  template <typename T>
+  void fill(const std::string& name, uint32_t offset, uint8_t datatype) {
+    msg.fields.push_back(makeField(name, offset, datatype));
+    for (uint32_t row = 0; row < msg.height; ++row) {
+      for (uint32_t col = 0; col < msg.width; ++col) {
+        const auto idx = row * msg.width + col;
+        const T value = static_cast<T>(idx * 37 + offset);
+        std::memcpy(ptr(row, col) + offset, &value, sizeof(T));
+      }
+    }
+  }
+
+  uint8_t* ptr(uint32_t row, uint32_t col) {
+    return msg.data.data() + row * msg.row_step + col * msg.point_step;
+  }
+
+  sensor_msgs::PointCloud2 msg;
+};
+
+void expectSameMat(const cv::Mat& lhs, const cv::Mat& rhs) {
+  ASSERT_EQ(lhs.empty(), rhs.empty());
+  if (lhs.empty()) {
+    return;
+  }
+
+  ASSERT_EQ(lhs.rows, rhs.rows);
+  ASSERT_EQ(lhs.cols, rhs.cols);
+  ASSERT_EQ(lhs.elemSize(), rhs.elemSize());
+  for (int row = 0; row < lhs.rows; ++row) {
+    SCOPED_TRACE("row: " + std::to_string(row));
+    EXPECT_EQ(0, std::memcmp(lhs.ptr<uint8_t>(row),
+                             rhs.ptr<uint8_t>(row),
+                             lhs.cols * lhs.elemSize()));
+  }
+}
+
+void expectSameAsGeneric(const sensor_msgs::PointCloud2& msg,
+                         PointcloudLayout expected_layout) {
+  EXPECT_EQ(detectPointcloudLayout(msg).layout, expected_layout);
+
+  CloudInputPacket expected(0, 0);
+  ASSERT_TRUE(fillPointcloudPacketGeneric(msg, expected, false));
+  CloudInputPacket result(0, 0);
+  ASSERT_TRUE(fillPointcloudPacket(msg, result, false));
+
+  expectSameMat(expected.points, result.points);
+  expectSameMat(expected.colors, result.colors);
+  expectSameMat(expected.labels, result.labels);
+}
+
+void expectSameAsSerial(const sensor_msgs::PointCloud2& msg, size_t num_threads) {
+  WorkerPool pool(num_threads);
+  CloudInputPacket expected(0, 0);
+  ASSERT_TRUE(fillPointcloudPacket(msg, expected, false));
+  CloudInputPacket result(0, 0);
+  ASSERT_TRUE(fillPointcloudPacket(msg, result, false, &pool));
+
+  expectSameMat(expected.points, result.points);
+  expectSameMat(expected.colors, result.colors);
+  expectSameMat(expected.labels, result.labels);
+}
+
+}  // namespace
+
+TEST(PointcloudAdaptor, PackedXyz) {
+  TestCloud cloud(3, 5, 12);
+  cloud.fill<float>("x", 0, PointField::FLOAT32);
+  cloud.fill<float>("y", 4, PointField::FLOAT32);
+  cloud.fill<float>("z", 8, PointField::FLOAT32);
+  cloud.msg.fields.resize(3);
+  expectSameAsGeneric(cloud.msg, PointcloudLayout::XYZ);
+}
+
+TEST(PointcloudAdaptor, PaddedXyzRgb) {
+  TestCloud cloud(2, 7, 32, 4);
+  cloud.fill<float>("x", 0, PointField::FLOAT32);
+  cloud.fill<float>("y", 4, PointField::FLOAT32);
+  cloud.fill<float>("z", 8, PointField::FLOAT32);
+  cloud.msg.fields.resize(3);
+  cloud.fill<uint32_t>("rgb", 16, PointField::UINT32);
+  expectSameAsGeneric(cloud.msg, PointcloudLayout::XYZ_RGB);
+}
+
+TEST(PointcloudAdaptor, XyzIntensityRing) {
+  TestCloud cloud(4, 6, 24);
+  cloud.fill<float>("x", 0, PointField::FLOAT32);
+  cloud.msg.fields.resize(3);
+  cloud.fill<float>("intensity", 16, PointField::FLOAT32);
+  cloud.fill<uint16_t>("ring", 20, PointField::UINT16);
+  expectSameAsGeneric(cloud.msg, PointcloudLayout::XYZ_INTENSITY_RING);
+}
+
+TEST(PointcloudAdaptor, XyzSignedLabel) {
+  TestCloud cloud(1, 9, 16);
+  cloud.fill<int8_t>("label", 12, PointField::INT8);
+  expectSameAsGeneric(cloud.msg, PointcloudLayout::XYZ_LABEL);
+}
+
+TEST(PointcloudAdaptor, UnknownLayoutFallsBack) {
+  TestCloud cloud(2, 3, 24);
+  cloud.msg.fields.clear();
+  cloud.fill<double>("x", 0, PointField::FLOAT64);
+  cloud.fill<double>("y", 8, PointField::FLOAT64);
+  cloud.fill<double>("z", 16, PointField::FLOAT64);
+  expectSameAsGeneric(cloud.msg, PointcloudLayout::GENERIC);
+}
+
+TEST(PointcloudAdaptor, MissingLabelsRejected) {
+  TestCloud cloud(2, 3, 12);
+  CloudInputPacket packet(0, 0);
+  EXPECT_FALSE(fillPointcloudPacket(cloud.msg, packet, true));
+}
+
+TEST(PointcloudAdaptor, ParallelMatchesSerial) {
+  TestCloud cloud(64, 33, 32, 8);
+  cloud.fill<float>("x", 0, PointField::FLOAT32);
+  cloud.fill<float>("y", 4, PointField::FLOAT32);
+  cloud.fill<float>("z", 8, PointField::FLOAT32);
+  cloud.msg.fields.resize(3);
+  cloud.fill<uint32_t>("rgb", 16, PointField::UINT32);
+  cloud.fill<uint16_t>("ring", 20, PointField::UINT16);
+  for (size_t num_threads : {1, 3, 7, 100}) {
+    SCOPED_TRACE("threads: " + std::to_string(num_threads));
+    expectSameAsSerial(cloud.msg, num_threads);
+  }
+}
+
+TEST(PointcloudAdaptor, ParallelGenericMatchesSerial) {
+  TestCloud cloud(17, 5, 24);
+  cloud.msg.fields.clear();
+  cloud.fill<double>("x", 0, PointField::FLOAT64);
+  cloud.fill<double>("y", 8, PointField::FLOAT64);
+  cloud.fill<double>("z", 16, PointField::FLOAT64);
+  expectSameAsSerial(cloud.msg, 4);
+}
+
+}  // namespace hydra
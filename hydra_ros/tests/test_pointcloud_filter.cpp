@@ -0,0 +1,129 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/pointcloud_filter.h>
+
+#include <limits>
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+CloudInputPacket makePacket(const std::vector<cv::Vec3f>& points) {
+  CloudInputPacket packet(0, 0);
+  packet.points = cv::Mat(1, static_cast<int>(points.size()), CV_32FC3);
+  packet.labels = cv::Mat(1, static_cast<int>(points.size()), CV_32SC1);
+  for (size_t i = 0; i < points.size(); ++i) {
+    packet.points.at<cv::Vec3f>(0, i) = points[i];
+    packet.labels.at<int32_t>(0, i) = i;
+  }
+
+  return packet;
+}
+
+std::vector<int32_t> keptLabels(const CloudInputPacket& packet) {
+  const auto labels = packet.labels.ptr<int32_t>(0);
+  return std::vector<int32_t>(labels, labels + packet.labels.total());
+}
+
+}  // namespace
+
+TEST(PointcloudFilter, FiltersRange) {
+  PointcloudFilter::Config config;
+  config.min_range = 1.0f;
+  config.max_range = 5.0f;
+  PointcloudFilter filter(config);
+
+  auto packet = makePacket(
+      {{0.5f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {0.0f, 4.0f, 0.0f}, {6.0f, 0.0f, 0.0f}});
+  EXPECT_EQ(filter.filter(packet), 2u);
+  EXPECT_EQ(keptLabels(packet), (std::vector<int32_t>{1, 2}));
+  EXPECT_EQ(packet.points.total(), 2u);
+}
+
+TEST(PointcloudFilter, FiltersHeight) {
+  PointcloudFilter::Config config;
+  config.min_z = -0.5f;
+  config.max_z = 1.0f;
+  PointcloudFilter filter(config);
+
+  auto packet =
+      makePacket({{0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.5f}, {1.0f, 0.0f, 2.0f}});
+  EXPECT_EQ(filter.filter(packet), 1u);
+  EXPECT_EQ(keptLabels(packet), std::vector<int32_t>{1});
+}
+
+TEST(PointcloudFilter, KeepsFirstPointPerVoxel) {
+  PointcloudFilter::Config config;
+  config.voxel_size = 1.0f;
+  PointcloudFilter filter(config);
+
+  auto packet = makePacket({{0.1f, 0.1f, 0.1f},
+                            {0.9f, 0.9f, 0.9f},
+                            {1.1f, 0.1f, 0.1f},
+                            {-0.1f, 0.1f, 0.1f}});
+  EXPECT_EQ(filter.filter(packet), 3u);
+  EXPECT_EQ(keptLabels(packet), (std::vector<int32_t>{0, 2, 3}));
+}
+
+TEST(PointcloudFilter, DropsNonFinitePoints) {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+  // infinite points would otherwise pass a disabled max range
+  PointcloudFilter::Config config;
+  config.voxel_size = 0.5f;
+  PointcloudFilter filter(config);
+
+  auto packet = makePacket(
+      {{inf, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, nan, 0.0f}, {0.0f, 0.0f, -inf}});
+  EXPECT_EQ(filter.filter(packet), 1u);
+  EXPECT_EQ(keptLabels(packet), std::vector<int32_t>{1});
+}
+
+TEST(PointcloudFilter, SkipsRangeAndHeightInWorldFrame) {
+  PointcloudFilter::Config config;
+  config.max_range = 5.0f;
+  config.max_z = 1.0f;
+  PointcloudFilter filter(config);
+
+  // range and height are measured from the world origin instead of the sensor
+  auto packet = makePacket({{10.0f, 0.0f, 2.0f}, {1.0f, 0.0f, 0.0f}});
+  packet.in_world_frame = true;
+  EXPECT_EQ(filter.filter(packet), 2u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/pose_timeline.h>
+
+#include <filesystem>
+
+namespace hydra {
+
+namespace {
+
+constexpr uint64_t kSecondNs = 1000000000;
+
+Eigen::Quaterniond yaw(double angle) {
+  return Eigen::Quaterniond(Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()));
+}
+
+}  // namespace
+
+TEST(PoseTimeline, InterpolatesBetweenSamples) {
+  PoseTimeline timeline;
+  timeline.add(
+      "odom", "base_link", 2 * kSecondNs, Eigen::Vector3d(2, 0, 0), yaw(M_PI / 2));
+  timeline.add("odom", "base_link", 1 * kSecondNs, Eigen::Vector3d::Zero(), yaw(0.0));
+  timeline.finalize();
+
+  PoseTimeline::Pose pose;
+  const auto status = timeline.lookup(3 * kSecondNs / 2, "odom", "base_link", pose);
+  ASSERT_EQ(status, PoseTimeline::Status::VALID);
+  EXPECT_NEAR(pose.to_p_from.x(), 1.0, 1.0e-9);
+  EXPECT_NEAR(pose.to_R_from.angularDistance(yaw(M_PI / 4)), 0.0, 1.0e-6);
+
+  ASSERT_EQ(timeline.lookup(0, "odom", "base_link", pose),
+            PoseTimeline::Status::VALID);
+  EXPECT_NEAR(pose.to_p_from.x(), 2.0, 1.0e-9);
+}
+
+TEST(PoseTimeline, ReportsFailuresWithoutThrowing) {
+  PoseTimeline timeline;
+  timeline.add("odom", "base_link", 1 * kSecondNs, Eigen::Vector3d::Zero(), yaw(0.0));
+  timeline.add("odom", "base_link", 2 * kSecondNs, Eigen::Vector3d::Zero(), yaw(0.0));
+  timeline.add(
+      "map", "other", 1 * kSecondNs, Eigen::Vector3d::Zero(), yaw(0.0), true);
+  timeline.finalize();
+
+  PoseTimeline::Pose pose;
+  EXPECT_EQ(timeline.lookup(3 * kSecondNs, "odom", "base_link", pose),
+            PoseTimeline::Status::EXTRAPOLATION);
+  EXPECT_EQ(timeline.lookup(kSecondNs, "odom", "camera", pose),
+            PoseTimeline::Status::UNKNOWN_FRAME);
+  EXPECT_EQ(timeline.lookup(kSecondNs, "odom", "other", pose),
+            PoseTimeline::Status::NOT_CONNECTED);
+}
+
+TEST(PoseTimeline, ComposesChains) {
+  PoseTimeline timeline;
+  // odom -> base_link is dynamic, base_link -> camera is static
+  timeline.add("odom", "base_link", 1 * kSecondNs, Eigen::Vector3d(1, 0, 0), yaw(0.0));
+  timeline.add("odom", "base_link", 3 * kSecondNs, Eigen::Vector3d(3, 0, 0), yaw(0.0));
+  timeline.add("/base_link", "camera", 0, Eigen::Vector3d(0, 1, 0), yaw(M_PI), true);
+  // odom -> imu is a second dynamic edge
+  timeline.add("odom", "imu", 0, Eigen::Vector3d::Zero(), yaw(0.0));
+  timeline.add("odom", "imu", 4 * kSecondNs, Eigen::Vector3d(0, 0, 4), yaw(0.0));
+  timeline.finalize();
+
+  PoseTimeline::Pose pose;
+  ASSERT_EQ(timeline.lookup(2 * kSecondNs, "odom", "camera", pose),
+            PoseTimeline::Status::VALID);
+  EXPECT_NEAR((pose.to_p_from - Eigen::Vector3d(2, 1, 0)).norm(), 0.0, 1.0e-9);
+  EXPECT_NEAR(pose.to_R_from.angularDistance(yaw(M_PI)), 0.0, 1.0e-6);
+
+  ASSERT_EQ(timeline.lookup(2 * kSecondNs, "camera", "odom", pose),
+            PoseTimeline::Status::VALID);
+  EXPECT_NEAR((pose.to_p_from - Eigen::Vector3d(2, 1, 0)).norm(), 0.0, 1.0e-9);
+
+  ASSERT_EQ(timeline.lookup(2 * kSecondNs, "imu", "camera", pose),
+            PoseTimeline::Status::VALID);
+  EXPECT_NEAR((pose.to_p_from - Eigen::Vector3d(2, 1, -2)).norm(), 0.0, 1.0e-9);
+
+  // the latest common time is limited by odom -> base_link
+  ASSERT_EQ(timeline.lookup(0, "imu", "camera", pose), PoseTimeline::Status::VALID);
+  EXPECT_NEAR((pose.to_p_from - Eigen::Vector3d(3, 1, -3)).norm(), 0.0, 1.0e-9);
+}
+
+TEST(PoseTimeline, RoundTripsThroughIndex) {
+  PoseTimeline timeline;
+  timeline.add("odom", "base_link", 1 * kSecondNs, Eigen::Vector3d(1, 0, 0), yaw(0.0));
+  timeline.add("odom", "base_link", 3 * kSecondNs, Eigen::Vector3d(3, 0, 0), yaw(1.0));
+  timeline.add("base_link", "camera", 0, Eigen::Vector3d(0, 1, 0), yaw(M_PI), true);
+  timeline.finalize();
+
+  const auto path = std::filesystem::temp_directory_path() / "test_pose_index.poses";
+  PoseTimeline::IndexKey key;
+  key.source_size = 1234;
+  key.source_mtime_ns = 5678;
+  ASSERT_TRUE(timeline.writeIndex(path, key));
+
+  const auto mapped = PoseTimeline::mapIndex(path, key);
+  ASSERT_TRUE(mapped);
+  EXPECT_EQ(mapped->numEdges(), 2u);
+  EXPECT_EQ(mapped->numSamples(), 3u);
+
+  PoseTimeline::Pose expected;
+  PoseTimeline::Pose result;
+  ASSERT_EQ(timeline.lookup(2 * kSecondNs, "odom", "camera", expected),
+            PoseTimeline::Status::VALID);
+  ASSERT_EQ(mapped->lookup(2 * kSecondNs, "odom", "camera", result),
+            PoseTimeline::Status::VALID);
+  EXPECT_NEAR((expected.to_p_from - result.to_p_from).norm(), 0.0, 1.0e-9);
+  EXPECT_NEAR(expected.to_R_from.angularDistance(result.to_R_from), 0.0, 1.0e-9);
+
+  // indices built from a different version of the bag are ignored
+  key.source_mtime_ns += 1;
+  EXPECT_FALSE(PoseTimeline::mapIndex(path, key));
+  key.source_mtime_ns -= 1;
+  key.static_only = true;
+  EXPECT_FALSE(PoseTimeline::mapIndex(path, key));
+
+  std::filesystem::remove(path);
+}
+
+}  // namespace hydra
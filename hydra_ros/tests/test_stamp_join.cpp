@@ -0,0 +1,94 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/stamp_join.h>
+
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+using Pairs = std::vector<std::pair<int, int>>;
+
+TEST(StampJoin, PairsExactStampsInAnyOrder) {
+  Pairs pairs;
+  StampJoin<int> join({0, 10}, [&](int lhs, int rhs) { pairs.emplace_back(lhs, rhs); });
+  join.add(0, 100, 1);
+  join.add(0, 200, 2);
+  join.add(1, 200, 20);
+  join.add(0, 300, 3);
+  join.add(1, 100, 10);
+  join.add(1, 301, 30);
+  join.flush();
+
+  EXPECT_EQ(pairs, (Pairs{{2, 20}, {1, 10}}));
+  EXPECT_EQ(join.stats().num_matched, 2u);
+  EXPECT_EQ(join.stats().num_unmatched[0], 1u);
+  EXPECT_EQ(join.stats().num_unmatched[1], 1u);
+  EXPECT_EQ(join.numPending(0), 0u);
+}
+
+TEST(StampJoin, PairsClosestStampWithinTolerance) {
+  Pairs pairs;
+  StampJoin<int> join({5, 10}, [&](int lhs, int rhs) { pairs.emplace_back(lhs, rhs); });
+  join.add(1, 94, 10);
+  join.add(1, 103, 11);
+  join.add(1, 99, 12);
+  // 99 is closest, 94 is outside the tolerance
+  join.add(0, 100, 1);
+  join.add(0, 108, 2);
+  join.add(0, 120, 3);
+
+  EXPECT_EQ(pairs, (Pairs{{1, 12}, {2, 11}}));
+  EXPECT_EQ(join.numPending(0), 1u);
+  EXPECT_EQ(join.numPending(1), 1u);
+}
+
+TEST(StampJoin, DropsOldestWhenFull) {
+  Pairs pairs;
+  StampJoin<int> join({0, 2}, [&](int lhs, int rhs) { pairs.emplace_back(lhs, rhs); });
+  join.add(0, 1, 1);
+  join.add(0, 2, 2);
+  join.add(0, 3, 3);
+  EXPECT_EQ(join.numPending(0), 2u);
+  EXPECT_EQ(join.stats().num_unmatched[0], 1u);
+
+  join.add(1, 1, 10);
+  join.add(1, 3, 30);
+  EXPECT_EQ(pairs, (Pairs{{3, 30}}));
+  EXPECT_EQ(join.numPending(1), 1u);
+}
+
+}  // namespace hydra
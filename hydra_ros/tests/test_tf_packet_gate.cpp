@@ -0,0 +1,140 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <geometry_msgs/TransformStamped.h>
+#include <gtest/gtest.h>
+#include <hydra_ros/input/tf_packet_gate.h>
+
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+constexpr uint64_t kSecondNs = 1000000000;
+
+void addTransform(tf2::BufferCore& buffer, uint64_t timestamp_ns) {
+  geometry_msgs::TransformStamped msg;
+  msg.header.stamp.fromNSec(timestamp_ns);
+  msg.header.frame_id = "odom";
+  msg.child_frame_id = "base_link";
+  msg.transform.rotation.w = 1.0;
+  buffer.setTransform(msg, "test");
+}
+
+struct PacketLog {
+  TfPacketGate::Sink sink() {
+    return [this](const InputPacket::Ptr& packet) {
+      stamps.push_back(packet->timestamp_ns);
+    };
+  }
+
+  std::vector<uint64_t> stamps;
+};
+
+InputPacket::Ptr makePacket(uint64_t timestamp_ns) {
+  return std::make_shared<CloudInputPacket>(timestamp_ns, 0);
+}
+
+}  // namespace
+
+TEST(TfPacketGate, ForwardsAvailablePacketsImmediately) {
+  tf2::BufferCore buffer;
+  addTransform(buffer, 1 * kSecondNs);
+  addTransform(buffer, 3 * kSecondNs);
+
+  TfPacketGate gate(buffer, "odom", "base_link", 1.0);
+  PacketLog log;
+  gate.submit(makePacket(2 * kSecondNs), log.sink());
+  EXPECT_EQ(log.stamps, std::vector<uint64_t>{2 * kSecondNs});
+  EXPECT_EQ(gate.numPending(), 0u);
+}
+
+TEST(TfPacketGate, ReleasesDeferredPacketsInOrder) {
+  tf2::BufferCore buffer;
+  addTransform(buffer, 1 * kSecondNs);
+
+  TfPacketGate gate(buffer, "odom", "base_link", 10.0);
+  PacketLog log;
+  gate.submit(makePacket(3 * kSecondNs), log.sink());
+  gate.submit(makePacket(2 * kSecondNs), log.sink());
+  EXPECT_TRUE(log.stamps.empty());
+  EXPECT_EQ(gate.numPending(), 2u);
+
+  // adding a transform notifies the gate
+  addTransform(buffer, 4 * kSecondNs);
+  std::vector<uint64_t> expected{2 * kSecondNs, 3 * kSecondNs};
+  EXPECT_EQ(log.stamps, expected);
+  EXPECT_EQ(gate.numPending(), 0u);
+}
+
+TEST(TfPacketGate, LaterPacketsAreNotBlocked) {
+  tf2::BufferCore buffer;
+  addTransform(buffer, 1 * kSecondNs);
+  addTransform(buffer, 3 * kSecondNs);
+
+  TfPacketGate gate(buffer, "odom", "base_link", 10.0);
+  PacketLog log;
+  gate.submit(makePacket(4 * kSecondNs), log.sink());
+  gate.submit(makePacket(2 * kSecondNs), log.sink());
+  EXPECT_EQ(log.stamps, std::vector<uint64_t>{2 * kSecondNs});
+  EXPECT_EQ(gate.numPending(), 1u);
+}
+
+TEST(TfPacketGate, DropsExpiredPackets) {
+  tf2::BufferCore buffer;
+  addTransform(buffer, 1 * kSecondNs);
+
+  TfPacketGate gate(buffer, "odom", "base_link", 1.0);
+  PacketLog log;
+  gate.submit(makePacket(2 * kSecondNs), log.sink());
+  gate.submit(makePacket(4 * kSecondNs), log.sink());
+  EXPECT_EQ(gate.numPending(), 1u);
+  EXPECT_EQ(gate.numDropped(), 1u);
+
+  addTransform(buffer, 5 * kSecondNs);
+  EXPECT_EQ(log.stamps, std::vector<uint64_t>{4 * kSecondNs});
+}
+
+TEST(TfPacketGate, ShutdownForwardsDirectly) {
+  tf2::BufferCore buffer;
+  TfPacketGate gate(buffer, "odom", "base_link", 1.0);
+  gate.shutdown();
+
+  PacketLog log;
+  gate.submit(makePacket(2 * kSecondNs), log.sink());
+  EXPECT_EQ(log.stamps, std::vector<uint64_t>{2 * kSecondNs});
+}
+
+}  // namespace hydra
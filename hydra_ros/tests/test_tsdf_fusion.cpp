@@ -0,0 +1,219 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/input/camera.h>
+#include <hydra/input/input_conversion.h>
+#include <hydra/reconstruction/projective_integrator.h>
+#include <hydra_ros/utils/tsdf_fusion.h>
+#include <hydra_ros/utils/worker_pool.h>
+
+namespace hydra {
+
+namespace {
+
+// running weighted mean of the observations behind a voxel
+void integrate(TsdfVoxel& voxel, float distance, float weight) {
+  const float total = voxel.weight + weight;
+  voxel.distance = (voxel.distance * voxel.weight + distance * weight) / total;
+  voxel.weight = total;
+}
+
+Camera::Config makeCameraConfig() {
+  Camera::Config config;
+  config.min_range = 0.1;
+  config.max_range = 5.0;
+  config.width = 64;
+  config.height = 48;
+  config.fx = 40.0;
+  config.fy = 40.0;
+  config.cx = 32.0;
+  config.cy = 24.0;
+  return config;
+}
+
+// a tilted, textured wall about 1.5 m in front of a camera sliding sideways
+InputData makeFrame(const std::shared_ptr<Camera>& camera, size_t index) {
+  const auto config = makeCameraConfig();
+  const double offset = 0.05 * index;
+  InputData data(camera);
+  data.timestamp_ns = (index + 1) * 100000000;
+  data.world_T_body = Eigen::Isometry3d::Identity();
+  data.world_T_body.translation() << offset, 0.0, 0.0;
+  data.depth_image = cv::Mat(config.height, config.width, CV_32FC1);
+  data.color_image = cv::Mat(config.height, config.width, CV_8UC3);
+  for (int v = 0; v < config.height; ++v) {
+    for (int u = 0; u < config.width; ++u) {
+      // intersection of the pixel ray with the plane z = 1.5 + 0.2 * x
+      const double dx = (u - config.cx) / config.fx;
+      data.depth_image.at<float>(v, u) = (1.5 + 0.2 * offset) / (1.0 - 0.2 * dx);
+      auto& color = data.color_image.at<cv::Vec3b>(v, u);
+      color[0] = 20 * index + 2 * u;
+      color[1] = 220 - 25 * index;
+      color[2] = 4 * v + 7 * index;
+    }
+  }
+
+  return data;
+}
+
+void integrateFrames(const ProjectiveIntegrator& integrator,
+                     const std::shared_ptr<Camera>& camera,
+                     size_t start,
+                     size_t end,
+                     VolumetricMap& map) {
+  for (size_t i = start; i < end; ++i) {
+    auto data = makeFrame(camera, i);
+    ASSERT_TRUE(conversions::normalizeData(data, false));
+    ASSERT_TRUE(camera->finalizeRepresentations(data));
+    integrator.updateMap(data, map);
+  }
+}
+
+}  // namespace
+
+TEST(TsdfFusion, VoxelFusionMatchesWeightedMean) {
+  TsdfVoxel serial;
+  TsdfVoxel first;
+  TsdfVoxel second;
+  for (size_t i = 0; i < 100; ++i) {
+    const float distance = 0.1f * std::sin(0.3f * i);
+    const float weight = 0.5f + 0.01f * i;
+    integrate(serial, distance, weight);
+    integrate(i < 40 ? first : second, distance, weight);
+  }
+
+  fuseTsdfVoxel(second, first);
+  EXPECT_NEAR(first.distance, serial.distance, 1.0e-6);
+  EXPECT_NEAR(first.weight, serial.weight, 1.0e-4);
+}
+
+TEST(TsdfFusion, VoxelFusionIgnoresUnobservedAndClampsWeight) {
+  TsdfVoxel observed;
+  observed.distance = 0.2f;
+  observed.weight = 3.0f;
+  observed.color.r = 100;
+
+  TsdfVoxel target = observed;
+  fuseTsdfVoxel(TsdfVoxel(), target);
+  EXPECT_EQ(target.distance, 0.2f);
+  EXPECT_EQ(target.weight, 3.0f);
+
+  TsdfVoxel other;
+  other.distance = -0.2f;
+  other.weight = 1.0f;
+  other.color.r = 200;
+  fuseTsdfVoxel(other, target, 2.0f);
+  EXPECT_NEAR(target.distance, 0.1f, 1.0e-6);
+  EXPECT_EQ(target.color.r, 125);
+  EXPECT_EQ(target.weight, 2.0f);
+}
+
+TEST(TsdfFusion, LayerFusionAllocatesAndFusesBlocks) {
+  TsdfLayer lhs(0.1f, 4);
+  TsdfLayer rhs(0.1f, 4);
+  const BlockIndex shared(0, 0, 0);
+  const BlockIndex only_rhs(1, 0, 0);
+
+  auto& lhs_voxel = lhs.allocateBlockPtr(shared)->getVoxel(0);
+  lhs_voxel.distance = 0.1f;
+  lhs_voxel.weight = 1.0f;
+  auto& rhs_voxel = rhs.allocateBlockPtr(shared)->getVoxel(0);
+  rhs_voxel.distance = 0.3f;
+  rhs_voxel.weight = 1.0f;
+  auto& new_voxel = rhs.allocateBlockPtr(only_rhs)->getVoxel(5);
+  new_voxel.distance = -0.05f;
+  new_voxel.weight = 2.0f;
+
+  WorkerPool pool(2);
+  EXPECT_EQ(fuseTsdfLayers(rhs, lhs, 1.0e5f, &pool), 2u);
+  ASSERT_TRUE(lhs.hasBlock(only_rhs));
+  EXPECT_NEAR(lhs.getBlock(shared).getVoxel(0).distance, 0.2f, 1.0e-6);
+  EXPECT_EQ(lhs.getBlock(shared).getVoxel(0).weight, 2.0f);
+  EXPECT_EQ(lhs.getBlock(only_rhs).getVoxel(5).distance, -0.05f);
+  EXPECT_EQ(lhs.getBlock(only_rhs).getVoxel(5).weight, 2.0f);
+}
+
+TEST(TsdfFusion, FusedSegmentsMatchSerialIntegration) {
+  VolumetricMap::Config map_config;
+  map_config.voxel_size = 0.05f;
+  map_config.voxels_per_side = 8;
+  map_config.truncation_distance = 0.15f;
+  ProjectiveIntegratorConfig integrator_config;
+  const ProjectiveIntegrator integrator(integrator_config);
+  const auto camera = std::make_shared<Camera>(makeCameraConfig());
+
+  const size_t num_frames = 6;
+  VolumetricMap serial(map_config);
+  integrateFrames(integrator, camera, 0, num_frames, serial);
+  VolumetricMap first(map_config);
+  integrateFrames(integrator, camera, 0, num_frames / 2, first);
+  VolumetricMap second(map_config);
+  integrateFrames(integrator, camera, num_frames / 2, num_frames, second);
+
+  WorkerPool pool(2);
+  fuseTsdfLayers(second.getTsdfLayer(),
+                 first.getTsdfLayer(),
+                 integrator_config.max_weight,
+                 &pool);
+
+  // bounds documented at the --jobs flag of reconstruct_mesh
+  const float max_distance_error = 1.0e-5f * map_config.truncation_distance;
+  const auto& fused = first.getTsdfLayer();
+  size_t num_observed = 0;
+  for (const auto& block : serial.getTsdfLayer()) {
+    ASSERT_TRUE(fused.hasBlock(block.index));
+    const auto& fused_block = fused.getBlock(block.index);
+    for (size_t v = 0; v < block.numVoxels(); ++v) {
+      const auto& expected = block.getVoxel(v);
+      const auto& result = fused_block.getVoxel(v);
+      if (expected.weight <= 0.0f) {
+        EXPECT_LE(result.weight, 0.0f);
+        continue;
+      }
+
+      ++num_observed;
+      EXPECT_NEAR(result.weight, expected.weight, 1.0e-5f * expected.weight);
+      EXPECT_NEAR(result.distance, expected.distance, max_distance_error);
+      EXPECT_NEAR(result.color.r, expected.color.r, 1);
+      EXPECT_NEAR(result.color.g, expected.color.g, 1);
+      EXPECT_NEAR(result.color.b, expected.color.b, 1);
+    }
+  }
+
+  EXPECT_GT(num_observed, 0u);
+  EXPECT_EQ(fused.numBlocks(), serial.getTsdfLayer().numBlocks());
+}
+
+}  // namespace hydra